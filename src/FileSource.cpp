@@ -0,0 +1,103 @@
+#if defined(__unix__) || defined(__APPLE__)
+
+#include "FileSource.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace JStream {
+
+    //////////////////
+    /// MMapSource ///
+    //////////////////
+
+    MMapSource::MMapSource(const char* path) {
+        int fd = open(path, O_RDONLY);
+        if(fd < 0) return;
+
+        struct stat st;
+        if(fstat(fd, &st) == 0) {
+            mLen = st.st_size;
+
+            if(mLen == 0) isOpen = true; // Empty files can't be mapped
+            else {
+                void* data = mmap(nullptr, mLen, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(data != MAP_FAILED) {
+                    madvise(data, mLen, MADV_SEQUENTIAL);
+                    mData = static_cast<const char*>(data);
+                    isOpen = true;
+                }
+            }
+        }
+
+        close(fd); // The mapping stays valid after closing the file
+    }
+
+    MMapSource::~MMapSource() {
+        if(mData != nullptr) munmap(const_cast<char*>(mData), mLen);
+    }
+
+    size_t MMapSource::nextBlock(const char*& block) {
+        if(mProvided || mData == nullptr) return 0;
+
+        mProvided = true;
+        block = mData;
+        return mLen;
+    }
+
+    ///////////////////
+    /// PreadSource ///
+    ///////////////////
+
+    PreadSource::PreadSource(const char* path, size_t blockSize) : mBlockSize(blockSize) {
+        if(blockSize == 0) return;
+
+        mFd = open(path, O_RDONLY);
+        if(mFd < 0) return;
+
+        #ifdef POSIX_FADV_SEQUENTIAL
+            posix_fadvise(mFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        #endif
+
+        mBuf = new char[2*blockSize];
+        isOpen = true;
+    }
+
+    PreadSource::~PreadSource() {
+        if(mFd >= 0) close(mFd);
+        delete[] mBuf;
+    }
+
+    size_t PreadSource::nextBlock(const char*& block) {
+        if(!isOpen || failed) return 0;
+
+        char* buf = mSecondBlock ? mBuf + mBlockSize : mBuf;
+
+        // Fill the block, pread may return less than requested
+        size_t len = 0;
+        while(len < mBlockSize) {
+            ssize_t n = mSequential ? read(mFd, buf + len, mBlockSize - len) : pread(mFd, buf + len, mBlockSize - len, mOffset + len);
+            if(n < 0) {
+                if(errno == EINTR) continue;
+                if(errno == ESPIPE && !mSequential) {
+                    mSequential = true;
+                    continue;
+                }
+                failed = true;
+                break;
+            }
+            if(n == 0) break;
+            len += n;
+        }
+
+        mOffset += len;
+        mSecondBlock = !mSecondBlock;
+        block = buf;
+        return len;
+    }
+
+} // JStream
+
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <JsonSource.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+namespace JStream {
+    /**
+     * @brief Provides a json file by mapping it into memory (POSIX hosts only)
+     * 
+     * The whole file is provided as a single block, therefore string views (see JsonParser::readString(StringView&)) stay valid as long as the source exists.
+     * The kernel is advised that the mapping is read sequentially, so it reads ahead aggressively.
+     */
+    class MMapSource : public JsonSource {
+        public:
+            bool isOpen = false;
+
+            MMapSource(const char* path);
+            MMapSource(const MMapSource& other) = delete;
+            MMapSource& operator=(const MMapSource& other) = delete;
+            ~MMapSource();
+
+            size_t nextBlock(const char*& block) override;
+        private:
+            const char* mData = nullptr;
+            size_t mLen = 0;
+            bool mProvided = false;
+    };
+
+    /**
+     * @brief Provides a json file by reading it block-wise with pread (POSIX hosts only)
+     * 
+     * Intended for files that shouldn't be mapped (e.g. on network filesystems). Pipes and other unseekable files are read sequentially.
+     * The source is double-buffered: a provided block stays valid until the block after the next one is requested.
+     */
+    class PreadSource : public JsonSource {
+        public:
+            bool isOpen = false;
+            bool failed = false; // Indicates that reading failed, the input then ends early (i.e. the json is incomplete)
+
+            /** @param blockSize Size of a single block, the source allocates two blocks */
+            PreadSource(const char* path, size_t blockSize=64*1024);
+            PreadSource(const PreadSource& other) = delete;
+            PreadSource& operator=(const PreadSource& other) = delete;
+            ~PreadSource();
+
+            size_t nextBlock(const char*& block) override;
+        private:
+            int mFd = -1;
+            off_t mOffset = 0;
+            char* mBuf = nullptr; // Two consecutive blocks
+            size_t mBlockSize;
+            bool mSecondBlock = false; // Indicates which of the two blocks is filled next
+            bool mSequential = false; // The file can't be read at an offset (e.g. a pipe)
+    };
+} // JStream
+
+#endif
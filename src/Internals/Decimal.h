@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace JStream {
+    namespace Internals {
+        /**
+         * @brief Significant digits that can decide the rounding of a decimal to a double
+         *
+         * Halfway points between two doubles have at most 767 significant digits, so further digits only tell
+         * whether a decimal that equals one up to there is above it.
+         */
+        const size_t MAX_ROUNDING_DIGITS = 768;
+
+        /**
+         * @brief Decimal number: (head * 10^tailDigits + tail + 0.rest) * 10^exponent
+         *
+         * The first 38 significant digits are stored in head and tail, which decide the rounding of almost all numbers.
+         * Decimals close to halfway between two doubles are rounded by the digits of rest, which only needs to hold
+         * up to MAX_ROUNDING_DIGITS in total (any further nonzero digits can be replaced by a single 1).
+         */
+        struct Decimal {
+            uint64_t head = 0; // First 19 significant digits
+            uint64_t tail = 0; // Up to 19 following digits
+            int tailDigits = 0;
+            bool truncated = false; // Nonzero digits followed the tail
+            const uint8_t* rest = nullptr; // Digits (0-9) after the tail, without trailing zeros
+            size_t restDigits = 0;
+            long exponent = 0; // Exponent of the last digit in head or tail
+            bool negative = false;
+        };
+
+        /**
+         * @brief Converts a decimal to the nearest double, ties are rounded to even
+         *
+         * Most numbers are converted with a single 64x64 bit multiplication by a power of five (Eisel-Lemire algorithm).
+         * Numbers with more than 19 significant digits, that aren't decided by their first 19 digits,
+         * are compared with the halfway point between the two candidate doubles in big integer arithmetic (incl. the rest).
+         * Targets without 64 bit doubles scale the mantissa by a table of powers of ten instead, which isn't exact.
+         */
+        double toDouble(const Decimal& decimal);
+    }
+}
@@ -3,6 +3,47 @@
 
 namespace JStream {
     namespace Internals {
+        #define C_ CHAR_OTHER
+        #define Q_ CHAR_QUOTE
+        #define B_ CHAR_BACKSLASH
+        #define O_ CHAR_OPEN
+        #define X_ CHAR_CLOSE
+        #define S_ CHAR_COMMA
+        const byte CHAR_CLASSES[256] = {
+        //  0   1   2   3   4   5   6   7   8   9   A   B   C   D   E   F
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0x00
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0x10
+            C_, C_, Q_, C_, C_, C_, C_, C_, C_, C_, C_, C_, S_, C_, C_, C_, // 0x20  '"' ','
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0x30
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0x40
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, O_, B_, X_, C_, C_, // 0x50  '[' '\' ']'
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0x60
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, O_, C_, X_, C_, C_, // 0x70  '{' '}'
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0x80
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0x90
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0xA0
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0xB0
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0xC0
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0xD0
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, // 0xE0
+            C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_, C_  // 0xF0
+        };
+        #undef C_
+        #undef Q_
+        #undef B_
+        #undef O_
+        #undef X_
+        #undef S_
+
+        #define T_(state, action) static_cast<byte>((action) << 4 | (state))
+        const byte SKIP_TRANSITIONS[SKIP_STATE_COUNT][CHAR_CLASS_COUNT] = {
+            //                other                            '"'                              '\\'                             '{' '['                              '}' ']'                               ','
+            /* OUTSIDE */ {T_(SKIP_OUTSIDE, ACTION_NONE), T_(SKIP_STRING, ACTION_NONE),  T_(SKIP_OUTSIDE, ACTION_NONE), T_(SKIP_OUTSIDE, ACTION_OPEN), T_(SKIP_OUTSIDE, ACTION_CLOSE), T_(SKIP_OUTSIDE, ACTION_COMMA)},
+            /* STRING */  {T_(SKIP_STRING, ACTION_NONE),  T_(SKIP_OUTSIDE, ACTION_NONE), T_(SKIP_ESCAPE, ACTION_NONE),  T_(SKIP_STRING, ACTION_NONE),  T_(SKIP_STRING, ACTION_NONE),   T_(SKIP_STRING, ACTION_NONE)},
+            /* ESCAPE */  {T_(SKIP_STRING, ACTION_NONE),  T_(SKIP_STRING, ACTION_NONE),  T_(SKIP_STRING, ACTION_NONE),  T_(SKIP_STRING, ACTION_NONE),  T_(SKIP_STRING, ACTION_NONE),   T_(SKIP_STRING, ACTION_NONE)}
+        };
+        #undef T_
+
         unsigned char escape(const unsigned char c) {
             switch(c) {
                 case '"': return '"';
@@ -1,5 +1,12 @@
 #pragma once
 
+#include <stdint.h>
+#include <Internals/Types.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && UINTPTR_MAX > 0xFFFFFFFF
+    #define JSTREAM_SWAR_DIGITS // 64 bit little endian hosts convert 8 digits at a time (see parseEightDigits())
+#endif
+
 namespace JStream {
     namespace Internals {
         /** @brief Returns true if a character is a valid json whitespace **/
@@ -8,10 +15,24 @@ namespace JStream {
         }
 
         /** @brief Returns true if a character is a valid json decimal digit **/
-        inline bool isDecDigit(const unsigned char c) {
+        constexpr bool isDecDigit(const unsigned char c) {
             return c >= 48 && c <= 57;
         }
 
+        /** @brief Returns true if all 8 chars of a block, that was loaded little endian, are decimal digits **/
+        inline bool isEightDigits(uint64_t block) {
+            // Digits are 0x30-0x39, adding 6 to them doesn't carry into the high nibble
+            return ((block & 0xF0F0F0F0F0F0F0F0ULL) | (((block + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+        }
+
+        /** @brief Returns the value of the 8 decimal digits of a block, that was loaded little endian (see isEightDigits()) **/
+        inline uint32_t parseEightDigits(uint64_t block) {
+            // Combines neighbouring digits, then pairs of them, then quadruples: 10*a + b, 100*ab + cd, 10000*abcd + efgh
+            block = (block & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+            block = (block & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+            return static_cast<uint32_t>((block & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+        }
+
         /** @brief Returns true if a character is a valid json decimal digit between (inclusive) 1 and 9 **/
         inline bool isOneNine(const unsigned char c) {
             return c >= 49 && c <= 57;
@@ -28,6 +49,11 @@ namespace JStream {
             return isDecDigit(c) || c == '-' || c == '+' || c == '.' || c == 'E' || c == 'e';
         }
 
+        /** @brief Returns true if a character opens/closes a json object, array or string **/
+        inline bool isScopeDelimiter(const unsigned char c) {
+            return c == '{' || c == '}' || c == '[' || c == ']' || c == '"';
+        }
+
         /** @brief Returns true if escaping a character results in a char valid in json. 
          * 
          * This function is designed to work with Json::escape. Since Json::escape can only escape single characters,
@@ -53,5 +79,17 @@ namespace JStream {
          * @param defaultVal The value that is returned if not a single digit could be parsed
         */
         double stod(const char* str, double defaultVal=0.0);
+
+        /** @brief Classes of chars that drive the skipping DFA */
+        enum CharClass : byte {CHAR_OTHER, CHAR_QUOTE, CHAR_BACKSLASH, CHAR_OPEN, CHAR_CLOSE, CHAR_COMMA, CHAR_CLASS_COUNT};
+        /** @brief States of the skipping DFA, the nesting level is tracked separately */
+        enum SkipState : byte {SKIP_OUTSIDE, SKIP_STRING, SKIP_ESCAPE, SKIP_STATE_COUNT};
+        /** @brief Side effects of a transition of the skipping DFA */
+        enum SkipAction : byte {ACTION_NONE, ACTION_OPEN, ACTION_CLOSE, ACTION_COMMA};
+
+        /** @brief Maps each char to its CharClass */
+        extern const byte CHAR_CLASSES[256];
+        /** @brief Transitions of the skipping DFA by state and char class, the next state is stored in the low and the action in the high nibble */
+        extern const byte SKIP_TRANSITIONS[SKIP_STATE_COUNT][CHAR_CLASS_COUNT];
     } // Internals
 }
\ No newline at end of file
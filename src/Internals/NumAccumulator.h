@@ -1,36 +1,51 @@
 #pragma once
 
-#include <limits.h>
+#include <Internals/Decimal.h>
+#include <vector>
 
 namespace JStream {
     namespace Internals {
         /**
-         * @brief Tool used to parse a json number in a stream by accumulating its value 
-         * 
-         * This class accelerates the parsing of json numbers by utilizing an int as a buffer:
-         *  - Parses the number to an int buffer "buf" (ignores decimal point) and remembers the number of decimal places "d"
-         *  - Adjusts decimal placee: d = d - exponent (in scientific notation)
-         *  - Calculates result: result = sign * ((double) buf) * 10^d
+         * @brief Tool used to parse a json number in a stream by accumulating its value
+         *
+         * The digits are accumulated into a Decimal, which is converted to the nearest double (see toDouble()):
+         *  - The first 19 significant digits are accumulated in a 64 bit int (ignores the decimal point and leading zeros),
+         *    the next 19 in a second one, further digits are counted and kept for the rounding (see Decimal::rest)
+         *    once a nonzero one occurs, so common numbers never allocate
+         *  - The decimal places and the counted digits adjust the exponent (in scientific notation)
          */
         class NumAccumulator {
              public:
                 enum NumSegment {PRE_DECIMAL, DECIMAL, EXPONENT};
 
-                double sign = 1;
-                unsigned long expSign = 1;
+                int sign = 1;
+                int expSign = 1;
                 bool segmentHasAtLeastOneDigit = false; // Indicates if the current segment has at least 1 digit (i.e. is defined)
                 NumSegment currentSegment = PRE_DECIMAL;
 
             private:
-                double result = 0.0;
-                unsigned long exponent = 0; // The exponent of the double (e.g. "1.2e-123": exponent = -123)
-                unsigned long buf = 0; // The int buffer
-                static const unsigned long buf_max = (ULONG_MAX-9)/10; // The maximum value the buffer can take
-                unsigned long tens_adjustment = 1;
+                static const int MAX_DIGITS = 19; // Digits that always fit into a 64 bit int
+                static const long MAX_EXPONENT = 100000000; // Exponents beyond it saturate, the number is zero/infinite anyway
+                static const size_t MAX_REST_DIGITS = MAX_ROUNDING_DIGITS + 1 - 2*MAX_DIGITS; // Rounding digits after the tail, and one for all further ones
+
+                Decimal decimal;
+                int headDigits = 0;
+                long exponent = 0; // The exponent of the double (e.g. "1.2e-123": exponent = 123, expSign = -1)
                 long decimalPlaces = 0;
+                long droppedDigits = 0; // Significant digits after the tail
+                std::vector<uint8_t> rest; // Digits after the tail up to the last nonzero one, see Decimal::rest
+                size_t restZeros = 0; // Zeros after the last nonzero digit of rest
+                bool integral = true; // Neither a decimal point nor an exponent was read
+
+                static uint64_t pow10(int n) {
+                    uint64_t power = 1;
+                    for(; n > 0; n--) power *= 10;
+                    return power;
+                }
 
             public:
                 void setSegment(NumSegment seg) {
+                    if(seg != PRE_DECIMAL) integral = false;
                     currentSegment = seg;
                     segmentHasAtLeastOneDigit = false;
                 }
@@ -42,32 +57,96 @@ namespace JStream {
                         case DECIMAL:
                             decimalPlaces++;
                         case PRE_DECIMAL:
-                            // Prevent overflow of the buffer
-                            if(buf > buf_max ) {
-                                if(result > 0) result *= tens_adjustment;
-                                result += buf;
-                                tens_adjustment = 1;
-                                buf = 0;
+                            if(headDigits < MAX_DIGITS) {
+                                if(headDigits == 0 && digit == 0) break; // Leading zeros aren't significant
+                                decimal.head = decimal.head*10 + digit;
+                                headDigits++;
+                            } else if(decimal.tailDigits < MAX_DIGITS) {
+                                decimal.tail = decimal.tail*10 + digit;
+                                decimal.tailDigits++;
+                            } else {
+                                droppedDigits++;
+                                if(!digit) restZeros++;
+                                else if(rest.size() < MAX_REST_DIGITS) {
+                                    // Digits after the last rounding digit can't equal a halfway point anymore, a single 1 stands for them
+                                    bool beyond = rest.size() + restZeros >= MAX_REST_DIGITS - 1;
+                                    rest.resize(beyond ? MAX_REST_DIGITS - 1 : rest.size() + restZeros, 0);
+                                    rest.push_back(beyond ? 1 : digit);
+                                    restZeros = 0;
+                                    decimal.truncated = true;
+                                }
                             }
-
-                            buf = buf*10 + digit;
-                            tens_adjustment *= 10;
                             break;
                         case EXPONENT:
-                            exponent = exponent*10 + digit;
+                            if(exponent < MAX_EXPONENT) exponent = exponent*10 + digit;
                     }
                 }
 
-                double get() {
-                    result *= tens_adjustment;
-                    result += buf;
+                /** @brief Returns true if the number has neither a decimal point nor an exponent */
+                bool isIntegral() const {
+                    return integral;
+                }
+
+                /**
+                 * @brief Returns the magnitude of the number times 10^decimals, rounded half away from zero
+                 * 
+                 * Only uses integer arithmetic, divisions are only needed if the number has more decimal places than decimals.
+                 * @param limit Maximum magnitude, larger ones saturate at it
+                 * @param overflowed Set to whether the magnitude saturated
+                 */
+                uint64_t getScaled(int decimals, uint64_t limit, bool& overflowed) const {
+                    overflowed = false;
+                    if(decimal.head == 0) return 0;
+
+                    // Number of leading digits before the scaled decimal point, the following digit is rounded
+                    long keep = headDigits + decimal.tailDigits + exponent*expSign - decimalPlaces + droppedDigits + decimals;
+                    if(keep <= 0) {
+                        uint64_t rounded = keep == 0 && decimal.head >= pow10(headDigits - 1)*5 ? 1 : 0;
+                        overflowed = rounded > limit; // E.g. negative numbers of unsigned types, whose limit is 0
+                        return overflowed ? limit : rounded;
+                    }
+
+                    uint64_t magnitude = decimal.head;
+                    unsigned int roundDigit = 0;
+                    if(keep < headDigits) {
+                        magnitude = decimal.head / pow10(static_cast<int>(headDigits - keep));
+                        roundDigit = decimal.head / pow10(static_cast<int>(headDigits - keep - 1)) % 10;
+                    } else {
+                        // Digits of the tail, then zeros
+                        long tailKeep = keep - headDigits < decimal.tailDigits ? keep - headDigits : decimal.tailDigits;
+                        uint64_t tail = decimal.tail / pow10(static_cast<int>(decimal.tailDigits - tailKeep));
+                        if(tailKeep < decimal.tailDigits) roundDigit = decimal.tail / pow10(static_cast<int>(decimal.tailDigits - tailKeep - 1)) % 10;
 
-                    decimalPlaces -= exponent * expSign;
+                        for(long i = headDigits; i < keep; i++) {
+                            if(magnitude > limit / 10) {
+                                overflowed = true;
+                                return limit;
+                            }
+                            magnitude *= 10;
+                        }
+                        if(tailKeep > 0) {
+                            tail *= pow10(static_cast<int>(keep - headDigits - tailKeep));
+                            if(magnitude > limit - tail) {
+                                overflowed = true;
+                                return limit;
+                            }
+                            magnitude += tail;
+                        }
+                    }
 
-                    if(decimalPlaces > 0) for(int i=0; i<decimalPlaces; i++) result *= 0.1;
-                    else if(decimalPlaces < 0) for(int i=0; i>decimalPlaces; i--) result *= 10;
+                    if(magnitude > limit || (roundDigit >= 5 && magnitude == limit)) {
+                        overflowed = true;
+                        return limit;
+                    }
+                    return roundDigit >= 5 ? magnitude + 1 : magnitude;
+                }
 
-                    return result * sign;
+                double get() {
+                    decimal.negative = sign < 0;
+                    decimal.exponent = exponent*expSign - decimalPlaces + droppedDigits;
+                    decimal.rest = rest.data();
+                    decimal.restDigits = rest.size();
+                    return toDouble(decimal);
                 }
 
                 void reset() {
@@ -75,13 +154,16 @@ namespace JStream {
                     expSign = 1;
                     segmentHasAtLeastOneDigit = false;
 
-                    result = 0.0;
+                    decimal = Decimal();
+                    headDigits = 0;
                     exponent = 0;
-                    buf = 0;
-                    tens_adjustment = 1;
                     decimalPlaces = 0;
+                    droppedDigits = 0;
+                    rest.clear();
+                    restZeros = 0;
+                    integral = true;
                     currentSegment = PRE_DECIMAL;
                 }
         };
     }
-}
\ No newline at end of file
+}
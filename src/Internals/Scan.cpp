@@ -0,0 +1,893 @@
+#include "Scan.h"
+#include <Internals/JsonUtils.h>
+#include <Internals/Decimal.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+    #include <immintrin.h>
+    #define JSTREAM_SCAN_SSE2
+    #define JSTREAM_SCAN_AVX2 // Compiled with a target attribute, only used if the cpu supports it
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define JSTREAM_SCAN_NEON
+    #ifdef __aarch64__
+        #define JSTREAM_SCAN_NEON_BITMAPS // Needs the pairwise adds of AArch64
+    #endif
+#endif
+
+#define JSTREAM_ALWAYS_INLINE inline __attribute__((always_inline))
+
+namespace JStream {
+    namespace Internals {
+        static const char* findQuoteOrEscapeScalar(const char* it, const char* end) {
+            while(it != end && *it != '"' && *it != '\\') it++;
+            return it;
+        }
+
+        //////////
+        // SWAR //
+        //////////
+
+        // Targets without SIMD (e.g. ESP8266, ESP32) still test the 4 chars of a 32 bit word at once
+
+        typedef uint32_t Word;
+        static const Word ONES = 0x01010101;
+        static const Word HIGH_BITS = 0x80808080;
+
+        /** @brief Returns non-zero if any byte of a word is zero */
+        static JSTREAM_ALWAYS_INLINE Word hasZero(Word w) {
+            return (w - ONES) & ~w & HIGH_BITS;
+        }
+
+        /** @brief Returns non-zero if any byte of a word is c */
+        static JSTREAM_ALWAYS_INLINE Word hasValue(Word w, unsigned char c) {
+            return hasZero(w ^ (ONES * c));
+        }
+
+        /** @brief Sets the high bit of exactly the bytes of a word that are c */
+        static JSTREAM_ALWAYS_INLINE Word matchValue(Word w, unsigned char c) {
+            w ^= ONES * c;
+            return ~(((w & ~HIGH_BITS) + ~HIGH_BITS) | w | ~HIGH_BITS);
+        }
+
+        /** @brief Loads the word at a 4 byte aligned address, Xtensa traps on unaligned loads */
+        static JSTREAM_ALWAYS_INLINE Word loadWord(const char* it) {
+            Word w;
+            memcpy(&w, __builtin_assume_aligned(it, sizeof(Word)), sizeof(Word));
+            return w;
+        }
+
+        /**
+         * @brief Returns the first word boundary at least 8 chars after it, or end if that comes first
+         * 
+         * Most runs (e.g. keys, separators) are shorter than that and are cheaper to scan char by char.
+         */
+        static JSTREAM_ALWAYS_INLINE const char* wordsStart(const char* it, const char* end) {
+            uintptr_t offset = (8 - reinterpret_cast<uintptr_t>(it)) & (sizeof(Word) - 1);
+            return end - it > static_cast<ptrdiff_t>(offset + 8) ? it + offset + 8 : end;
+        }
+
+#if !defined(JSTREAM_SCAN_SSE2) && !defined(JSTREAM_SCAN_NEON)
+        static const char* findQuoteOrEscapeSwar(const char* it, const char* end) {
+            for(const char* words = wordsStart(it, end); it != words; it++) {
+                if(*it == '"' || *it == '\\') return it;
+            }
+
+            for(; end - it >= static_cast<ptrdiff_t>(sizeof(Word)); it += sizeof(Word)) {
+                Word w = loadWord(it);
+                if(hasValue(w, '"') | hasValue(w, '\\')) break;
+            }
+            return findQuoteOrEscapeScalar(it, end);
+        }
+#endif
+
+        /** @brief Returns the first '{', '}', '[', ']' or '"' in [it, end), or end if there is none */
+        static const char* findScopeDelimiter(const char* it, const char* end) {
+            for(const char* words = wordsStart(it, end); it != words; it++) {
+                if(isScopeDelimiter(*it)) return it;
+            }
+
+            for(; end - it >= static_cast<ptrdiff_t>(sizeof(Word)); it += sizeof(Word)) {
+                Word w = loadWord(it);
+                Word folded = w | (ONES * 0x20); // '[' -> '{', ']' -> '}'
+                if(hasValue(folded, '{') | hasValue(folded, '}') | hasValue(w, '"')) break;
+            }
+
+            while(it != end && !isScopeDelimiter(*it)) it++;
+            return it;
+        }
+
+        const char* findNonWhitespace(const char* it, const char* end) {
+            for(const char* words = wordsStart(it, end); it != words; it++) {
+                if(!isWhitespace(*it)) return it;
+            }
+
+            for(; end - it >= static_cast<ptrdiff_t>(sizeof(Word)); it += sizeof(Word)) {
+                Word w = loadWord(it);
+                if(w == ONES * ' ') continue; // Indentation
+
+                Word whitespace = matchValue(w, ' ') | matchValue(w, '\n') | matchValue(w, '\r') | matchValue(w, '\t');
+                if(whitespace != HIGH_BITS) break;
+            }
+
+            while(it != end && isWhitespace(*it)) it++;
+            return it;
+        }
+
+#ifdef JSTREAM_SCAN_SSE2
+        static const char* findQuoteOrEscapeSse2(const char* it, const char* end) {
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i escape = _mm_set1_epi8('\\');
+
+            for(; end - it >= 16; it += 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, escape)));
+                if(mask) return it + __builtin_ctz(mask);
+            }
+            return findQuoteOrEscapeScalar(it, end);
+        }
+#endif
+
+#ifdef JSTREAM_SCAN_AVX2
+        __attribute__((target("avx2")))
+        static const char* findQuoteOrEscapeAvx2(const char* it, const char* end) {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i escape = _mm256_set1_epi8('\\');
+
+            for(; end - it >= 32; it += 32) {
+                __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+                unsigned int mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, escape)));
+                if(mask) return it + __builtin_ctz(mask);
+            }
+            return findQuoteOrEscapeSse2(it, end);
+        }
+#endif
+
+#ifdef JSTREAM_SCAN_NEON
+        static const char* findQuoteOrEscapeNeon(const char* it, const char* end) {
+            const uint8x16_t quote = vdupq_n_u8('"');
+            const uint8x16_t escape = vdupq_n_u8('\\');
+
+            for(; end - it >= 16; it += 16) {
+                uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(it));
+                uint8x16_t matches = vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, escape));
+
+                // Narrow each byte of the match mask to a nibble, NEON has no movemask
+                uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+                if(mask) return it + (__builtin_ctzll(mask) >> 2);
+            }
+            return findQuoteOrEscapeScalar(it, end);
+        }
+#endif
+
+        static const char* skipNestedScalar(const char* it, const char* end, size_t& depth, bool& inStr, bool& escape) {
+            while(it != end && (inStr || depth > 0)) {
+                if(inStr) {
+                    if(!escape) {
+                        it = findQuoteOrEscape(it, end);
+                        if(it == end) break;
+                    }
+
+                    char c = *it++;
+                    if(escape) escape = false;
+                    else if(c == '\\') escape = true;
+                    else if(c == '"') inStr = false;
+                } else {
+                    it = findScopeDelimiter(it, end);
+                    if(it == end) break;
+
+                    switch(*it++) {
+                        case '{': case '[':
+                            depth++;
+                            break;
+                        case '}': case ']':
+                            depth--;
+                            break;
+                        case '"':
+                            inStr = true;
+                            escape = false;
+                            break;
+                    }
+                }
+            }
+            return it;
+        }
+
+        /** @brief Bitmaps of the chars of a 64 char block that matter for skipping, bit i corresponds to the i-th char */
+        struct BlockMasks {
+            uint64_t quote;
+            uint64_t backslash;
+            uint64_t open; // '{' and '['
+            uint64_t close; // '}' and ']'
+        };
+
+        /** @brief Carries the string and escape state from one block to the next */
+        struct BlockCarry {
+            uint64_t inStr; // All bits set if the block starts within a string
+            uint64_t escaped; // 1 if the first char of the block is escaped
+        };
+
+        /** @brief Returns a mask where each bit is the xor of itself and all lower bits */
+        static JSTREAM_ALWAYS_INLINE uint64_t prefixXor(uint64_t x) {
+            x ^= x << 1;
+            x ^= x << 2;
+            x ^= x << 4;
+            x ^= x << 8;
+            x ^= x << 16;
+            x ^= x << 32;
+            return x;
+        }
+
+        /**
+         * @brief Skips a block given its masks
+         * @return The offset after the char that ended skipping, 0 if skipping continues in the next block
+         */
+        static JSTREAM_ALWAYS_INLINE unsigned int skipBlock(BlockMasks masks, BlockCarry& carry, size_t& depth) {
+            const uint64_t EVEN_BITS = 0x5555555555555555ULL;
+
+            // Find escaped chars, i.e. chars after an odd number of backslashes (see simdjson)
+            uint64_t backslash = masks.backslash & ~carry.escaped;
+            uint64_t followsEscape = backslash << 1 | carry.escaped;
+            uint64_t oddStarts = backslash & ~EVEN_BITS & ~followsEscape;
+            uint64_t evenStarts;
+            carry.escaped = __builtin_add_overflow(oddStarts, backslash, &evenStarts);
+            uint64_t escaped = (EVEN_BITS ^ (evenStarts << 1)) & followsEscape;
+
+            // Mask the chars within strings, including the opening but not the closing quotes
+            uint64_t quote = masks.quote & ~escaped;
+            if(depth == 0) { // Only the pending string is left
+                if(quote) return __builtin_ctzll(quote) + 1;
+                return 0;
+            }
+            uint64_t inStr = prefixXor(quote) ^ carry.inStr;
+            carry.inStr = static_cast<uint64_t>(static_cast<int64_t>(inStr) >> 63);
+
+            uint64_t open = masks.open & ~inStr;
+            uint64_t close = masks.close & ~inStr;
+
+            // Depth can't reach 0 within the block
+            if(static_cast<size_t>(__builtin_popcountll(close)) < depth) {
+                depth += __builtin_popcountll(open);
+                depth -= __builtin_popcountll(close);
+                return 0;
+            }
+
+            // Jump from bracket to bracket
+            uint64_t brackets = open | close;
+            while(brackets) {
+                unsigned int i = __builtin_ctzll(brackets);
+                depth += 1 - 2*(close >> i & 1); // Branchless, opening and closing brackets are unpredictable
+                if(depth == 0) return i + 1;
+
+                brackets &= brackets - 1;
+            }
+            return 0;
+        }
+
+        /** 
+         * @brief Skips blocks of 64 chars while a kernel computes their masks
+         * @param it Updated to the position after the skipped chars
+         * @return true if skipping ended
+         */
+        #define JSTREAM_SKIP_BLOCKS(blockMasks) \
+            BlockCarry carry = {inStr ? ~0ULL : 0, escape ? 1ULL : 0}; \
+            size_t blockDepth = depth; /* Kept in a register, depth might alias */ \
+            for(; end - it >= 64; it += 64) { \
+                unsigned int offset = skipBlock(blockMasks(it), carry, blockDepth); \
+                if(offset > 0) { \
+                    depth = 0; \
+                    inStr = false; \
+                    escape = false; \
+                    return it + offset; \
+                } \
+            } \
+            depth = blockDepth; \
+            if(depth > 0) inStr = carry.inStr != 0; \
+            escape = inStr && carry.escaped;
+
+#ifdef JSTREAM_SCAN_SSE2
+        static JSTREAM_ALWAYS_INLINE BlockMasks blockMasksSse2(const char* it) {
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i open = _mm_set1_epi8('{');
+            const __m128i close = _mm_set1_epi8('}');
+            const __m128i caseBit = _mm_set1_epi8(0x20);
+
+            __m128i chunks[4] = {
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(it)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 16)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 32)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 48))
+            };
+
+            BlockMasks masks = {0, 0, 0, 0};
+            for(int i = 0; i < 4; i++) {
+                __m128i folded = _mm_or_si128(chunks[i], caseBit); // '[' -> '{', ']' -> '}'
+
+                masks.quote |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[i], quote))) << 16*i;
+                masks.backslash |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[i], backslash))) << 16*i;
+                masks.open |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, open))) << 16*i;
+                masks.close |= static_cast<uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, close))) << 16*i;
+            }
+            return masks;
+        }
+
+        static const char* skipNestedSse2(const char* it, const char* end, size_t& depth, bool& inStr, bool& escape) {
+            JSTREAM_SKIP_BLOCKS(blockMasksSse2)
+            return skipNestedScalar(it, end, depth, inStr, escape);
+        }
+#endif
+
+#ifdef JSTREAM_SCAN_AVX2
+        __attribute__((target("avx2,popcnt")))
+        static JSTREAM_ALWAYS_INLINE BlockMasks blockMasksAvx2(const char* it) {
+            const __m256i quote = _mm256_set1_epi8('"');
+            const __m256i backslash = _mm256_set1_epi8('\\');
+            const __m256i open = _mm256_set1_epi8('{');
+            const __m256i close = _mm256_set1_epi8('}');
+            const __m256i caseBit = _mm256_set1_epi8(0x20);
+
+            __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it + 32));
+            __m256i loFolded = _mm256_or_si256(lo, caseBit); // '[' -> '{', ']' -> '}'
+            __m256i hiFolded = _mm256_or_si256(hi, caseBit);
+
+            BlockMasks masks;
+            masks.quote = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote)))
+                | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)))) << 32;
+            masks.backslash = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, backslash)))
+                | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, backslash)))) << 32;
+            masks.open = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(loFolded, open)))
+                | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hiFolded, open)))) << 32;
+            masks.close = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(loFolded, close)))
+                | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hiFolded, close)))) << 32;
+            return masks;
+        }
+
+        __attribute__((target("avx2,popcnt")))
+        static const char* skipNestedAvx2(const char* it, const char* end, size_t& depth, bool& inStr, bool& escape) {
+            JSTREAM_SKIP_BLOCKS(blockMasksAvx2)
+            return skipNestedScalar(it, end, depth, inStr, escape);
+        }
+#endif
+
+#ifdef JSTREAM_SCAN_NEON_BITMAPS
+        /** @brief Packs the bytes of 4 comparison results to a 64 bit mask, NEON has no movemask */
+        static JSTREAM_ALWAYS_INLINE uint64_t toBitmask(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3) {
+            const uint8x16_t bits = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+
+            uint8x16_t sum0 = vpaddq_u8(vandq_u8(m0, bits), vandq_u8(m1, bits));
+            uint8x16_t sum1 = vpaddq_u8(vandq_u8(m2, bits), vandq_u8(m3, bits));
+            sum0 = vpaddq_u8(sum0, sum1);
+            sum0 = vpaddq_u8(sum0, sum0);
+            return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+        }
+
+        static JSTREAM_ALWAYS_INLINE BlockMasks blockMasksNeon(const char* it) {
+            const uint8x16_t quote = vdupq_n_u8('"');
+            const uint8x16_t backslash = vdupq_n_u8('\\');
+            const uint8x16_t open = vdupq_n_u8('{');
+            const uint8x16_t close = vdupq_n_u8('}');
+            const uint8x16_t caseBit = vdupq_n_u8(0x20);
+
+            uint8x16_t chunks[4];
+            uint8x16_t folded[4];
+            for(int i = 0; i < 4; i++) {
+                chunks[i] = vld1q_u8(reinterpret_cast<const uint8_t*>(it + 16*i));
+                folded[i] = vorrq_u8(chunks[i], caseBit); // '[' -> '{', ']' -> '}'
+            }
+
+            BlockMasks masks;
+            masks.quote = toBitmask(vceqq_u8(chunks[0], quote), vceqq_u8(chunks[1], quote), vceqq_u8(chunks[2], quote), vceqq_u8(chunks[3], quote));
+            masks.backslash = toBitmask(vceqq_u8(chunks[0], backslash), vceqq_u8(chunks[1], backslash), vceqq_u8(chunks[2], backslash), vceqq_u8(chunks[3], backslash));
+            masks.open = toBitmask(vceqq_u8(folded[0], open), vceqq_u8(folded[1], open), vceqq_u8(folded[2], open), vceqq_u8(folded[3], open));
+            masks.close = toBitmask(vceqq_u8(folded[0], close), vceqq_u8(folded[1], close), vceqq_u8(folded[2], close), vceqq_u8(folded[3], close));
+            return masks;
+        }
+
+        static const char* skipNestedNeon(const char* it, const char* end, size_t& depth, bool& inStr, bool& escape) {
+            JSTREAM_SKIP_BLOCKS(blockMasksNeon)
+            return skipNestedScalar(it, end, depth, inStr, escape);
+        }
+#endif
+
+        typedef const char* (*ScanFn)(const char* it, const char* end);
+
+        /** @brief Selects the fastest kernel the cpu supports */
+        static ScanFn selectFindQuoteOrEscape() {
+#if defined(JSTREAM_SCAN_AVX2)
+            if(__builtin_cpu_supports("avx2")) return findQuoteOrEscapeAvx2;
+            return findQuoteOrEscapeSse2;
+#elif defined(JSTREAM_SCAN_SSE2)
+            return findQuoteOrEscapeSse2;
+#elif defined(JSTREAM_SCAN_NEON)
+            return findQuoteOrEscapeNeon;
+#else
+            return findQuoteOrEscapeSwar;
+#endif
+        }
+
+        const char* findQuoteOrEscape(const char* it, const char* end) {
+            static const ScanFn impl = selectFindQuoteOrEscape();
+            return impl(it, end);
+        }
+
+        typedef const char* (*SkipFn)(const char* it, const char* end, size_t& depth, bool& inStr, bool& escape);
+
+        /** @brief Selects the fastest kernel the cpu supports */
+        static SkipFn selectSkipNested() {
+#if defined(JSTREAM_SCAN_AVX2)
+            if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) return skipNestedAvx2;
+            return skipNestedSse2;
+#elif defined(JSTREAM_SCAN_SSE2)
+            return skipNestedSse2;
+#elif defined(JSTREAM_SCAN_NEON_BITMAPS)
+            return skipNestedNeon;
+#else
+            return skipNestedScalar;
+#endif
+        }
+
+        const char* skipNested(const char* it, const char* end, size_t& depth, bool& inStr, bool& escape) {
+            static const SkipFn impl = selectSkipNested();
+
+            if(depth == 0 && !inStr) return it; // Nothing pending
+            return impl(it, end, depth, inStr, escape);
+        }
+
+        ////////////////////
+        // Binary strings //
+        ////////////////////
+
+        /** @brief Value of each char as a base64 or hex digit */
+        struct DigitTables {
+            byte base64[256];
+            byte hex[256];
+
+            DigitTables() {
+                memset(base64, NOT_A_DIGIT, sizeof(base64));
+                memset(hex, NOT_A_DIGIT, sizeof(hex));
+
+                const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+                for(byte i = 0; i < 64; i++) base64[static_cast<unsigned char>(alphabet[i])] = i;
+                base64[static_cast<unsigned char>('-')] = 62; // url-safe alphabet
+                base64[static_cast<unsigned char>('_')] = 63;
+
+                for(byte i = 0; i < 10; i++) hex['0' + i] = i;
+                for(byte i = 0; i < 6; i++) hex['a' + i] = hex['A' + i] = 10 + i;
+            }
+        };
+
+        static const DigitTables& digitTables() {
+            static const DigitTables tables;
+            return tables;
+        }
+
+        byte base64Value(unsigned char c) {
+            return digitTables().base64[c];
+        }
+
+        byte hexValue(unsigned char c) {
+            return digitTables().hex[c];
+        }
+
+        static size_t decodeBase64Scalar(const char*& it, const char* end, byte* out, size_t room) {
+            const byte* values = digitTables().base64;
+            byte* start = out;
+            for(; end - it >= 4 && room >= 3; it += 4, out += 3, room -= 3) {
+                byte a = values[static_cast<unsigned char>(it[0])];
+                byte b = values[static_cast<unsigned char>(it[1])];
+                byte c = values[static_cast<unsigned char>(it[2])];
+                byte d = values[static_cast<unsigned char>(it[3])];
+                if((a | b | c | d) & 0x80) break; // Not a digit
+
+                uint32_t group = static_cast<uint32_t>(a) << 18 | static_cast<uint32_t>(b) << 12 | static_cast<uint32_t>(c) << 6 | d;
+                out[0] = static_cast<byte>(group >> 16);
+                out[1] = static_cast<byte>(group >> 8);
+                out[2] = static_cast<byte>(group);
+            }
+            return out - start;
+        }
+
+#ifdef JSTREAM_SCAN_AVX2
+        /**
+         * @brief Decodes 32 base64 digits at a time, validating and translating them with nibble lookups (see Muła & Lemire, "Faster Base64 Encoding and Decoding using AVX2 Instructions")
+         * 
+         * Only the standard alphabet is decoded this way, blocks with any other char are left to the scalar kernel.
+         */
+        __attribute__((target("avx2")))
+        static size_t decodeBase64Avx2(const char*& it, const char* end, byte* out, size_t room) {
+            const __m256i lutLo = _mm256_setr_epi8(
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            const __m256i lutHi = _mm256_setr_epi8(
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m256i lutRoll = _mm256_setr_epi8(
+                0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i mask2F = _mm256_set1_epi8(0x2F);
+            const __m256i pack = _mm256_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+            byte* start = out;
+            for(; end - it >= 32 && room >= 32; it += 32, out += 24, room -= 24) { // The store writes 32 bytes
+                __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+
+                // Each nibble pair of a digit has a common bit in the lookups, other chars don't
+                __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(chunk, 4), mask2F);
+                __m256i lo = _mm256_shuffle_epi8(lutLo, _mm256_and_si256(chunk, mask2F));
+                __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+                if(!_mm256_testz_si256(lo, hi)) break;
+
+                // Translate the digits to their values, the high nibble selects the offset ('/' has its own)
+                __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(chunk, mask2F), hiNibbles));
+                __m256i values = _mm256_add_epi8(chunk, roll);
+
+                // Merge each 4 values into 3 bytes
+                __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+                merged = _mm256_shuffle_epi8(merged, pack);
+                merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), merged);
+            }
+            return (out - start) + decodeBase64Scalar(it, end, out, room);
+        }
+#endif
+
+        typedef size_t (*DecodeFn)(const char*& it, const char* end, byte* out, size_t room);
+
+        /** @brief Selects the fastest kernel the cpu supports */
+        static DecodeFn selectDecodeBase64() {
+#if defined(JSTREAM_SCAN_AVX2)
+            if(__builtin_cpu_supports("avx2")) return decodeBase64Avx2;
+#endif
+            return decodeBase64Scalar;
+        }
+
+        size_t decodeBase64(const char*& it, const char* end, byte* out, size_t room) {
+            static const DecodeFn impl = selectDecodeBase64();
+            return impl(it, end, out, room);
+        }
+
+        size_t decodeHex(const char*& it, const char* end, byte* out, size_t room) {
+            const byte* values = digitTables().hex;
+            byte* start = out;
+            for(; end - it >= 2 && room > 0; it += 2, out++, room--) {
+                byte hi = values[static_cast<unsigned char>(it[0])];
+                byte lo = values[static_cast<unsigned char>(it[1])];
+                if((hi | lo) & 0x80) break; // Not a digit
+                *out = static_cast<byte>(hi << 4 | lo);
+            }
+            return out - start;
+        }
+
+        /////////////
+        // Numbers //
+        /////////////
+
+        static const int MAX_PLAIN_DIGITS = 19; // Digits of a plain number, they always fit into a 64 bit int
+        static const int MAX_PLAIN_EXPONENT_DIGITS = 6; // Larger exponents are left to NumAccumulator, which saturates them
+
+        static const uint64_t POWERS_OF_TEN[MAX_PLAIN_DIGITS + 1] = {
+            1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+            10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+            10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+        };
+
+        /**
+         * @brief Appends the digits at the start of [it, end) to value, count is the number of digits of value
+         * @return The position after the digits, nullptr if value would exceed MAX_PLAIN_DIGITS digits
+         */
+        static JSTREAM_ALWAYS_INLINE const char* readDigits(const char* it, const char* end, uint64_t& value, int& count) {
+            uint64_t acc = value;
+            int n = count;
+            for(; it != end && isDecDigit(*it); it++) {
+                if(++n > MAX_PLAIN_DIGITS) return nullptr;
+                acc = acc*10 + (*it - '0');
+            }
+            value = acc;
+            count = n;
+            return it;
+        }
+
+        static JSTREAM_ALWAYS_INLINE const char* skipWhitespace(const char* it, const char* end) {
+            while(it != end && isWhitespace(*it)) it++;
+            return it;
+        }
+
+        /**
+         * @brief Scans a plain number and the whitespace around it char by char (see parseNumbers())
+         * @return The position after it, nullptr if it isn't a plain number
+         */
+        template<bool FRACTIONS>
+        static JSTREAM_ALWAYS_INLINE const char* scanNumber(const char* it, const char* end, Decimal& number) {
+            it = skipWhitespace(it, end);
+            number.negative = it != end && *it == '-';
+            it += number.negative;
+
+            int digits = 0;
+            it = readDigits(it, end, number.head, digits);
+            if(it == nullptr || digits == 0) return nullptr;
+
+            if(FRACTIONS && it != end && *it == '.') {
+                const char* fraction = ++it;
+                it = readDigits(it, end, number.head, digits);
+                if(it == nullptr || it == fraction) return nullptr;
+                number.exponent = -(it - fraction);
+            }
+            if(FRACTIONS && it != end && (*it == 'e' || *it == 'E')) {
+                bool negative = ++it != end && *it == '-';
+                if(it != end && (*it == '-' || *it == '+')) it++;
+
+                uint64_t exponent = 0;
+                int expDigits = 0;
+                it = readDigits(it, end, exponent, expDigits);
+                if(expDigits == 0 || expDigits > MAX_PLAIN_EXPONENT_DIGITS) return nullptr;
+                number.exponent += negative ? -static_cast<long>(exponent) : static_cast<long>(exponent);
+            }
+
+            return skipWhitespace(it, end);
+        }
+
+        /** @brief Consumes the separator after an element, returns false if there is none (']' isn't consumed) */
+        static JSTREAM_ALWAYS_INLINE bool separator(const char*& it, const char* end, bool& closed) {
+            if(it == end) return false;
+            if(*it == ',') {
+                it++;
+                return true;
+            }
+            closed = *it == ']';
+            return closed;
+        }
+
+#if defined(JSTREAM_SWAR_DIGITS) && (defined(JSTREAM_SCAN_SSE2) || defined(JSTREAM_SCAN_NEON_BITMAPS))
+    #define JSTREAM_SCAN_NUMBER_BLOCKS
+#endif
+
+#ifdef JSTREAM_SCAN_NUMBER_BLOCKS
+        // Elements are located by the bitmaps of a block, their digits are converted without scanning them (see parseBlock())
+
+        /** @brief Chars a block needs to be readable, digit runs near its end are loaded 16 chars at a time */
+        static const ptrdiff_t NUMBER_BLOCK_READ = 64 + 16;
+
+        /** @brief Bitmaps of the chars of a 64 char block that make up plain numbers, bit i corresponds to the i-th char */
+        struct NumberMasks {
+            uint64_t digits;
+            uint64_t separators; // ',' and ']'
+            uint64_t whitespace; // Includes the other control chars, which are ignored like whitespace around numbers
+            uint64_t marks; // '-', '+', '.', 'e' and 'E', also ',' which never is within a number
+        };
+
+    #ifdef JSTREAM_SCAN_SSE2
+        static JSTREAM_ALWAYS_INLINE NumberMasks numberMasks(const char* it) {
+            NumberMasks masks = {0, 0, 0, 0};
+            for(int i = 0; i < 4; i++) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it + 16*i));
+                __m128i values = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+                __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(values, _mm_set1_epi8(9)), values);
+                __m128i separators = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8(']')));
+                __m128i whitespace = _mm_cmpeq_epi8(_mm_min_epu8(chunk, _mm_set1_epi8(' ')), chunk);
+                __m128i signs = _mm_sub_epi8(chunk, _mm_set1_epi8('+')); // '+', ',', '-', '.'
+                __m128i marks = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(signs, _mm_set1_epi8(3)), signs),
+                    _mm_cmpeq_epi8(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), _mm_set1_epi8('e')));
+
+                masks.digits |= static_cast<uint64_t>(_mm_movemask_epi8(digits)) << 16*i;
+                masks.separators |= static_cast<uint64_t>(_mm_movemask_epi8(separators)) << 16*i;
+                masks.whitespace |= static_cast<uint64_t>(_mm_movemask_epi8(whitespace)) << 16*i;
+                masks.marks |= static_cast<uint64_t>(_mm_movemask_epi8(marks)) << 16*i;
+            }
+            return masks;
+        }
+    #else
+        static JSTREAM_ALWAYS_INLINE NumberMasks numberMasks(const char* it) {
+            uint8x16_t digits[4], separators[4], whitespace[4], marks[4];
+            for(int i = 0; i < 4; i++) {
+                uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(it + 16*i));
+                digits[i] = vcleq_u8(vsubq_u8(chunk, vdupq_n_u8('0')), vdupq_n_u8(9));
+                separators[i] = vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(',')), vceqq_u8(chunk, vdupq_n_u8(']')));
+                whitespace[i] = vcleq_u8(chunk, vdupq_n_u8(' '));
+                marks[i] = vorrq_u8(vcleq_u8(vsubq_u8(chunk, vdupq_n_u8('+')), vdupq_n_u8(3)), // '+', ',', '-', '.'
+                    vceqq_u8(vorrq_u8(chunk, vdupq_n_u8(0x20)), vdupq_n_u8('e')));
+            }
+
+            NumberMasks masks;
+            masks.digits = toBitmask(digits[0], digits[1], digits[2], digits[3]);
+            masks.separators = toBitmask(separators[0], separators[1], separators[2], separators[3]);
+            masks.whitespace = toBitmask(whitespace[0], whitespace[1], whitespace[2], whitespace[3]);
+            masks.marks = toBitmask(marks[0], marks[1], marks[2], marks[3]);
+            return masks;
+        }
+    #endif
+
+        /** @brief Returns the bits [from, to) */
+        static JSTREAM_ALWAYS_INLINE uint64_t bitRange(unsigned int from, unsigned int to) {
+            return ((1ULL << (to - from)) - 1) << from;
+        }
+
+        /** @brief Returns the value of n <= MAX_PLAIN_DIGITS digits, 16 chars from it have to be readable */
+        static JSTREAM_ALWAYS_INLINE uint64_t digitsValue(const char* it, unsigned int n) {
+            uint64_t high, low;
+            memcpy(&high, it, 8);
+            if(n <= 8) return n > 0 ? parseEightDigits(high << (64 - 8*n)) : 0; // Shifts out the chars after the digits
+
+            memcpy(&low, it + 8, 8);
+            if(n <= 16) return parseEightDigits(high)*POWERS_OF_TEN[n - 8] + parseEightDigits(low << (128 - 8*n));
+
+            uint64_t value = parseEightDigits(high)*100000000ULL + parseEightDigits(low);
+            for(unsigned int i = 16; i < n; i++) value = value*10 + (it[i] - '0');
+            return value;
+        }
+
+        /**
+         * @brief Parses the plain number in [from, to) of a block given its masks, same behaviour as scanNumber()
+         * 
+         * Its parts are located by the marks in it, the digits of each part are checked by the masks.
+         * @return false if it isn't a plain number
+         */
+        template<bool FRACTIONS>
+        static JSTREAM_ALWAYS_INLINE bool blockNumber(const char* block, const NumberMasks& masks, unsigned int from, unsigned int to, Decimal& number) {
+            // Most elements are integers or decimals without whitespace. Branchless on the sign, random signs would be mispredicted
+            number.negative = block[from] == '-';
+            unsigned int first = from + number.negative;
+            if(first < to && to - first <= MAX_PLAIN_DIGITS + 1) {
+                uint64_t others = bitRange(first, to) & ~masks.digits;
+                if(others == 0 && to - first <= MAX_PLAIN_DIGITS) {
+                    number.head = digitsValue(block + first, to - first);
+                    return true;
+                }
+
+                unsigned int point = __builtin_ctzll(others | 1ULL << 63);
+                if(FRACTIONS && (others & (others - 1)) == 0 && block[point] == '.' && point > first && point + 1 < to) {
+                    unsigned int fractionDigits = to - point - 1;
+                    number.head = digitsValue(block + first, point - first)*POWERS_OF_TEN[fractionDigits] + digitsValue(block + point + 1, fractionDigits);
+                    number.exponent = -static_cast<long>(fractionDigits);
+                    return true;
+                }
+            }
+
+            // Strip the whitespace around the number
+            uint64_t chars = bitRange(from, to) & ~masks.whitespace;
+            if(chars == 0) return false;
+            unsigned int start = __builtin_ctzll(chars);
+            unsigned int end = 64 - __builtin_clzll(chars);
+
+            uint64_t span = bitRange(start, end);
+            if(((masks.digits | masks.marks) & span) != span) return false; // Other chars or whitespace within the number
+            uint64_t marks = masks.marks & span;
+
+            // Other marks at the start leave no digits
+            number.negative = block[start] == '-';
+            start += number.negative;
+            marks &= marks - number.negative; // Clears the lowest mark, which is the sign
+
+            unsigned int pos = marks ? __builtin_ctzll(marks) : end;
+            unsigned int digits = pos - start;
+            if(digits == 0 || digits > MAX_PLAIN_DIGITS) return false;
+            number.head = digitsValue(block + start, digits);
+            if(marks == 0) return true;
+            if(!FRACTIONS) return false;
+
+            if(block[pos] == '.') {
+                marks &= marks - 1;
+                unsigned int fraction = pos + 1;
+                pos = marks ? __builtin_ctzll(marks) : end;
+                unsigned int fractionDigits = pos - fraction;
+                if(fractionDigits == 0 || digits + fractionDigits > MAX_PLAIN_DIGITS) return false;
+                number.head = number.head*POWERS_OF_TEN[fractionDigits] + digitsValue(block + fraction, fractionDigits);
+                number.exponent = -static_cast<long>(fractionDigits);
+                if(marks == 0) return true;
+            }
+
+            if((block[pos] | 0x20) != 'e') return false;
+            marks &= marks - 1;
+            bool negative = false;
+            if(marks & 1ULL << (pos + 1)) { // Sign of the exponent
+                pos++;
+                if(block[pos] != '-' && block[pos] != '+') return false;
+                negative = block[pos] == '-';
+                marks &= marks - 1;
+            }
+            unsigned int expDigits = end - pos - 1;
+            if(marks != 0 || expDigits == 0 || expDigits > MAX_PLAIN_EXPONENT_DIGITS) return false;
+            long exponent = static_cast<long>(digitsValue(block + pos + 1, expDigits));
+            number.exponent += negative ? -exponent : exponent;
+            return true;
+        }
+
+        /**
+         * @brief Parses the elements of a block from separator to separator, same behaviour as parseNumbers()
+         * 
+         * The element that the block ends in is left to the next block.
+         * @param it The block, advanced past the parsed elements
+         * @param put Called with the index and value of each element, returns false if it doesn't take the value
+         * @param closed Set to true if the array was closed
+         * @return The number of parsed elements
+         */
+        template<bool FRACTIONS, typename Put>
+        static JSTREAM_ALWAYS_INLINE size_t parseBlock(const NumberMasks& masks, const char*& it, size_t room, bool& closed, Put put) {
+            uint64_t separators = masks.separators;
+            unsigned int start = 0;
+            size_t n = 0;
+            while(separators != 0 && n < room) {
+                unsigned int sep = __builtin_ctzll(separators);
+                Decimal number;
+                if(!blockNumber<FRACTIONS>(it, masks, start, sep, number) || !put(n, number)) break;
+                n++;
+
+                if(it[sep] == ']') {
+                    closed = true;
+                    start = sep;
+                    break;
+                }
+                start = sep + 1;
+                separators &= separators - 1;
+            }
+            it += start;
+            return n;
+        }
+#endif
+
+        size_t parseNumbers(const char*& it, const char* end, double* out, size_t room) {
+            size_t n = 0;
+            bool closed = false;
+            while(n < room && !closed) {
+#ifdef JSTREAM_SCAN_NUMBER_BLOCKS
+                if(end - it >= NUMBER_BLOCK_READ) {
+                    size_t parsed = parseBlock<true>(numberMasks(it), it, room - n, closed, [out, n](size_t i, const Decimal& number) {
+                        out[n + i] = toDouble(number);
+                        return true;
+                    });
+                    n += parsed;
+                    if(parsed > 0) continue;
+                }
+#endif
+                // One element at a time, near the end of the range or if it's longer than a block
+                Decimal number;
+                const char* next = scanNumber<true>(it, end, number);
+                if(next == nullptr || !separator(next, end, closed)) break;
+
+                out[n++] = toDouble(number);
+                it = next;
+            }
+            return n;
+        }
+
+        /** @brief Returns false if the magnitude of a plain integer is out of the range of int64_t, or it's negative but negatives aren't allowed */
+        static JSTREAM_ALWAYS_INLINE bool inInt64(const Decimal& number, bool negatives) {
+            // Branchless on the sign, the magnitude of the minimum is one more than the maximum
+            return (number.head <= static_cast<uint64_t>(INT64_MAX) + number.negative) & (negatives | !number.negative);
+        }
+
+        static JSTREAM_ALWAYS_INLINE int64_t toInt64(const Decimal& number) {
+            uint64_t sign = 0 - static_cast<uint64_t>(number.negative);
+            return static_cast<int64_t>((number.head ^ sign) - sign);
+        }
+
+        size_t parseIntegers(const char*& it, const char* end, int64_t* out, size_t room, bool negatives) {
+            size_t n = 0;
+            bool closed = false;
+            while(n < room && !closed) {
+#ifdef JSTREAM_SCAN_NUMBER_BLOCKS
+                if(end - it >= NUMBER_BLOCK_READ) {
+                    size_t parsed = parseBlock<false>(numberMasks(it), it, room - n, closed, [out, n, negatives](size_t i, const Decimal& number) {
+                        if(!inInt64(number, negatives)) return false;
+                        out[n + i] = toInt64(number);
+                        return true;
+                    });
+                    n += parsed;
+                    if(parsed > 0) continue;
+                }
+#endif
+                Decimal number;
+                const char* next = scanNumber<false>(it, end, number);
+                if(next == nullptr || !inInt64(number, negatives) || !separator(next, end, closed)) break;
+
+                out[n++] = toInt64(number);
+                it = next;
+            }
+            return n;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Internals/Types.h>
+
+namespace JStream {
+    namespace Internals {
+        /**
+         * @brief Returns the first '"' or '\' in [it, end), or end if there is none
+         * 
+         * Scans 16-32 chars at a time with SSE2/AVX2 (selected at runtime) or NEON, if the target supports them,
+         * otherwise 4 chars at a time within 32 bit words.
+         */
+        const char* findQuoteOrEscape(const char* it, const char* end);
+
+        /** @brief Returns the first char in [it, end) that isn't json whitespace, or end if there is none. Tests 4 chars at a time. */
+        const char* findNonWhitespace(const char* it, const char* end);
+
+        /**
+         * @brief Skips the rest of the pending collections and string in [it, end)
+         * 
+         * Skipping ends after the char that closes the outermost pending collection, or the pending string if depth is 0.
+         * If the target supports SIMD, each full 64 char block is skipped structural-to-structural
+         * using bitmaps of its quotes, backslashes and brackets, with the string contents masked out.
+         * 
+         * @param depth Nesting level of the pending collections, updated to the level at the returned position
+         * @param inStr Whether it lies within a string, updated to the returned position
+         * @param escape Whether the char at it is escaped, updated to the returned position
+         * @return The position after the skipped chars, end if the range ended first
+         */
+        const char* skipNested(const char* it, const char* end, size_t& depth, bool& inStr, bool& escape);
+
+        /** @brief Marks chars that aren't base64/hex digits (see base64Value(), hexValue()) */
+        const byte NOT_A_DIGIT = 0xFF;
+
+        /** @brief Returns the value of a base64 digit of the standard or the url-safe alphabet, NOT_A_DIGIT if it isn't one */
+        byte base64Value(unsigned char c);
+
+        /** @brief Returns the value of a hex digit (upper or lower case), NOT_A_DIGIT if it isn't one */
+        byte hexValue(unsigned char c);
+
+        /**
+         * @brief Decodes the groups of 4 base64 digits at the start of [it, end), as long as they are valid and fit into out
+         * 
+         * Decoding stops before the first group with another char (e.g. padding, '"', '\\'), which is left to the caller.
+         * 32 digits are decoded at a time with AVX2 (selected at runtime) if the target supports it, otherwise group by group.
+         * 
+         * @param it Advanced past the decoded digits
+         * @param room Size of out in bytes
+         * @return The number of decoded bytes
+         */
+        size_t decodeBase64(const char*& it, const char* end, byte* out, size_t room);
+
+        /** @brief Decodes the pairs of hex digits at the start of [it, end), same behaviour as decodeBase64() */
+        size_t decodeHex(const char*& it, const char* end, byte* out, size_t room);
+
+        /**
+         * @brief Parses the elements of an array of numbers at the start of [it, end), as long as they are plain numbers and fit into out
+         * 
+         * A plain number has an optional '-', at most 19 digits, an optional fraction and exponent, and is followed by ',' or the closing ']'
+         * (whitespace aside). Parsing stops before the first other element (e.g. a malformed or longer number, or one that isn't followed by
+         * its separator within the range), which is left to the caller, and at the closing ']', which isn't consumed.
+         * Blocks of 64 chars are classified into bitmaps (digits, separators, whitespace, signs/points/exponents) with SSE2/NEON, the elements
+         * are split at the separators and their digits converted 8 at a time within 64 bit words; otherwise it parses char by char.
+         * 
+         * @param it Advanced past the parsed elements
+         * @param room Size of out in elements
+         * @return The number of parsed elements
+         */
+        size_t parseNumbers(const char*& it, const char* end, double* out, size_t room);
+
+        /**
+         * @brief Parses the elements of an array of integers at the start of [it, end), same behaviour as parseNumbers()
+         * 
+         * Plain integers have neither a fraction nor an exponent and are in the range of int64_t.
+         * @param negatives If false, negative integers are left to the caller
+         */
+        size_t parseIntegers(const char*& it, const char* end, int64_t* out, size_t room, bool negatives);
+    }
+}
@@ -1,18 +1,98 @@
 #pragma once
 
 #include <vector>
+#include <functional>
 #include <Stream.h>
 #include <Path.h>
+#include <KeySet.h>
+#include <Query.h>
+#include <JsonSource.h>
 #include <limits>
+#include <type_traits>
+#include <string.h>
 #include <WString.h>
+#include <Internals/JsonUtils.h>
+#include <Internals/NumAccumulator.h>
+#include <Internals/Scan.h>
 
 namespace JStream {
+    template<size_t SEGMENTS, size_t CHARS>
+    class StaticPath; // See StaticPath.h, which needs C++14
+
+    /** @brief Non-owning view of a string in the parsed input */
+    struct StringView {
+        const char* data = nullptr;
+        size_t length = 0;
+    };
+
+    /** @brief Json number, that stays an integer if it has neither a fraction nor an exponent (see JsonParser::parseNumber()) */
+    struct Number {
+        enum Type : byte {NONE, INT, DOUBLE};
+
+        Type type = NONE; // NONE if not a single digit could be parsed
+        int64_t integer = 0; // Value of INT numbers
+        double real = 0.0; // Value of DOUBLE numbers
+
+        /** @brief Returns the value of the number as a double, 0 if it's NONE */
+        double toDouble() const { return type == INT ? static_cast<double>(integer) : real; }
+    };
+
     class JsonParser {
         public:
             JsonParser();
             JsonParser(Stream& stream);
+            JsonParser(Stream& stream, char* buf, size_t bufSize);
+            JsonParser(const char* json, size_t len);
+            JsonParser(JsonSource& source);
 
             void parse(Stream& stream);
+            /**
+             * @brief Parses a stream through a read-ahead window
+             * 
+             * Instead of reading the stream char by char, blocks of up to bufSize available chars are read into buf.
+             * The parser then scans the window and only accesses the stream again once the window is used up.
+             * 
+             * Note: Chars in the window are already consumed from the stream. They can only be read through the parser.
+             * 
+             * @param buf The window, has to outlive the parsing of the stream
+             * @param bufSize Size of the window in bytes
+             */
+            void parse(Stream& stream, char* buf, size_t bufSize);
+            /**
+             * @brief Parses json that is already in memory
+             * 
+             * The json is scanned in place, without any copying. Strings can be read as views into the json (see readString(StringView&)).
+             * 
+             * @param json The json, has to outlive the parsing
+             * @param len Length of the json in bytes
+             */
+            void parse(const char* json, size_t len);
+            /**
+             * @brief Parses json provided by a custom source
+             * 
+             * The source is called whenever the parser used up its current block (see JsonSource).
+             */
+            void parse(JsonSource& source);
+            /**
+             * @brief Parses json that is fed to the parser in chunks as it arrives (see feed())
+             * 
+             * Operations that run out of input before the json ended fail and needsMore() returns true.
+             * They keep their progress (e.g. nesting level, string/escape state, number digits).
+             * After the next chunk was fed, calling the same operation with the same arguments resumes it where it stopped.
+             * Calling a different operation discards the progress.
+             */
+            void parseIncremental();
+            /**
+             * @brief Feeds the next chunk of json when parsing incrementally
+             * 
+             * The chunk is scanned in place, it has to stay valid until needsMore() returns true.
+             * Unconsumed chars of the previous chunk are discarded.
+             */
+            void feed(const char* chunk, size_t len);
+            /** @brief Signals that no more chunks will be fed, the end of the last chunk is then treated as the end of the json */
+            void endInput();
+            /** @brief Returns true if the last operation ran out of input and can be resumed after feeding the next chunk */
+            bool needsMore();
             /** @brief Returns true if the stream is at the closing '}'/']' of the current parent object/array */
             bool atEnd();
             /**
@@ -43,6 +123,20 @@ namespace JStream {
              * @return true if a next key exists, false otherwise
              */
             bool nextKey(String* buf);
+            /**
+             * @brief Returns true if a next valid key in the current json object exists and stores a view of it
+             * 
+             * Behaves like nextKey(String*), but doesn't copy the key (see readString(StringView&)).
+             * If the next key can't be viewed, the method fails with the stream positioned at the opening '"' of the key.
+             * In that case atEnd() returns false and the key can be read with nextKey(String*).
+             */
+            bool nextKey(StringView& key);
+            /**
+             * @brief Returns true if a next valid key in the current json object exists and stores it in a fixed-capacity buffer
+             * 
+             * Behaves like nextKey(String*), keys that don't fit are truncated (see readString(char*, size_t, size_t*, bool)).
+             */
+            bool nextKey(char* buf, size_t size, size_t* length=nullptr);
             /**
              * @brief Reads the stream until it finds the searched for key in the current object
              * 
@@ -57,6 +151,20 @@ namespace JStream {
              * @return true If the key was found in the current object(/array), false otherwise
              */
             bool findKey(const char* thekey);
+            /**
+             * @brief Reads the stream until it finds the next key of the current object that is in the key set
+             * 
+             * Stream position:
+             * - on success: First char of the value corresponding to the key
+             * - on fail: At closing ']'/'}' of the current array/object
+             * 
+             * Behaviour:
+             * - Same as findKey(), but looks for several keys at once, e.g. to collect the fields of an object in one pass
+             * - Key chars are matched against the trie of the set while reading them, unknown keys are skipped at their first mismatched char
+             * 
+             * @return The index of the found key in the set, -1 if no further key of the set is in the current object
+             */
+            int nextKeyOf(const KeySet& keys);
             /** 
              * @brief Reads the stream until it finds the value at the given path. 
              * 
@@ -77,8 +185,50 @@ namespace JStream {
              *  - "akey": KEY segment, child of a json object
              *  - "key1/key2[2]/key3": KEY segments are seperated from previous segments with a '/'
              *  - "akey[2][2]": OFFSET segments can be appended directly to previous segments 
+             *  - "[*]", "*": Wildcards, find the first element/key
+             *  - "..akey", "**": Descendants, find "akey" at any depth (see Query::maxDepth), the search can't be resumed when parsing incrementally
+             *  - "[?akey==\"val\"]": Predicates, find the first element whose member "akey" matches (see PathPredicate), the search can't be resumed when parsing incrementally
+             * 
+             * Paths without descendants or predicates are matched in place, nothing is allocated.
              */
             bool find(const char* path);
+            /**
+             * @brief Reads the stream until it finds the value at a path, that was parsed at compile time (see JSTREAM_PATH)
+             * 
+             * Same behaviour as find(Path&), without parsing the path or allocating any memory.
+             */
+            template<size_t SEGMENTS, size_t CHARS>
+            bool find(const StaticPath<SEGMENTS, CHARS>& path) {
+                return path.isValid && findStatic(path.segments, SEGMENTS, path.keys);
+            }
+            /**
+             * @brief Walks the immediately following value once and calls the callback for every value at one of the query's paths
+             * 
+             * Unlike find(), the paths don't have to be searched in the order of the json. They are relative to the walked value,
+             * i.e. their first segment is a member of it. Values that aren't on any path are skipped without looking at them.
+             * 
+             * The callback is called with the index of the path, while the stream is positioned at the first char of the path's value.
+             * It may read the value (objects/arrays it entered have to be exited again), the rest of the value is skipped afterwards.
+             * If a path leads through the value of another path, the value is only walked further if the callback didn't read it.
+             * Objects are exited as soon as the values of all their keys leading to paths were visited, repeated keys might not be visited.
+             * 
+             * Note: The walk can't be resumed when parsing incrementally.
+             * 
+             * Stream position:
+             * - on success: First non-whitespace char after the walked value
+             * 
+             * @return false if the query is invalid or the json ended before the walked value did
+             */
+            bool query(Query& query, const std::function<void(size_t path)>& callback);
+            /**
+             * @brief Walks the immediately following value once and calls the callback for every value at the path
+             * 
+             * Same behaviour as query() with a single path, which can contain wildcards to visit several values (e.g. "books[*]/author").
+             * The rest of each visited value is skipped after the callback.
+             */
+            bool forEach(Path& path, const std::function<void()>& callback);
+            /** @brief Walks the immediately following value once and calls the callback for every value at the path, see forEach(Path&) */
+            bool forEach(const char* path, const std::function<void()>& callback);
             /**
              * @brief Enters the immediatley following json array
              * Skips whitespace, fails if the next json element isn't beginning of an array
@@ -99,6 +249,31 @@ namespace JStream {
              * @param levels The number of parent objects/arrays to exit
              */
             bool exitCollection(size_t levels=1);
+            /**
+             * @brief Skips until the given number of enclosing objects/arrays were closed
+             * 
+             * Same behaviour as exitCollection(), all skipping is driven by a single table-driven DFA.
+             * 
+             * Stream position:
+             * - on success: After the closing '}'/']' of the outermost exited object/array
+             */
+            bool skipToDepth(size_t levels);
+            /**
+             * @brief Skips until the start of the n-th succeeding sibling in the current object/array
+             * 
+             * Stream position:
+             * - on success: First char of the n-th sibling (key or value)
+             * - on fail: At closing ']'/'}' of the current array/object
+             */
+            bool skipToNextSibling(size_t n=1);
+            /**
+             * @brief Skips the immediately following value (string, object, array, number or literal)
+             * 
+             * Stream position:
+             * - on success: First non-whitespace char after the value (e.g. ',', ']' or '}')
+             * - on fail: At the closing ']'/'}' or ',' if there is no value
+             */
+            bool skipValue();
             /** @brief Skips the next object/array in the stream */
             bool skipCollection();
             /**
@@ -117,6 +292,55 @@ namespace JStream {
              * @param inStr Indicates whether the stream is positioned inside the string or before the opening '"'
              */
             bool readString(String& buf, bool inStr=false);
+            /**
+             * @brief Reads a string from the stream as a view into the input, without copying it
+             * 
+             * Only strings without escaped chars, that lie completely in the input window can be viewed.
+             * In-memory input (see parse(const char*, size_t)) is one big window, for a JsonSource the window is its current block.
+             * The view is valid until the window is refilled.
+             * If the string can't be viewed, nothing is consumed and the string can be read with readString(String&) instead.
+             * 
+             * @param inStr Indicates whether the stream is positioned inside the string or before the opening '"'
+             */
+            bool readString(StringView& view, bool inStr=false);
+            /**
+             * @brief Reads a string from the stream into a fixed-capacity buffer, without allocating any memory
+             * 
+             * Chars that don't fit into the buffer are skipped, the stored chars are always null-terminated.
+             * 
+             * @param buf Buffer of size bytes, including the terminating '\0'
+             * @param length Receives the full length of the string, it was truncated if length >= size (optional)
+             * @param inStr Indicates whether the stream is positioned inside the string or before the opening '"'
+             */
+            bool readString(char* buf, size_t size, size_t* length=nullptr, bool inStr=false);
+            /**
+             * @brief Reads a string of any length from the stream in chunks, that are unescaped into a fixed-capacity buffer
+             * 
+             * The callback is called whenever the buffer is full, and once more with the remaining chars at the closing '"'.
+             * It must not use the parser. When parsing incrementally, the same buffer has to be passed to resume the string.
+             * 
+             * @param buf Buffer of size bytes, which is the size of each chunk but the last
+             * @param callback Called with each chunk and its length, chunks aren't null-terminated
+             * @param inStr Indicates whether the stream is positioned inside the string or before the opening '"'
+             */
+            bool readStringChunks(char* buf, size_t size, const std::function<void(const char* chunk, size_t len)>& callback, bool inStr=false);
+            /**
+             * @brief Decodes a base64 string from the stream into a fixed-capacity buffer, without copying the string
+             * 
+             * Both the standard and the url-safe alphabet are decoded, padding is optional and whitespace (e.g. escaped line breaks) is ignored.
+             * Bytes that don't fit into the buffer are skipped, fails at the first char that isn't part of the encoding.
+             * 
+             * @param buf Buffer of size bytes
+             * @param length Receives the full decoded length, the bytes were truncated if length > size (optional)
+             * @param inStr Indicates whether the stream is positioned inside the string or before the opening '"'
+             */
+            bool readBase64(byte* buf, size_t size, size_t* length=nullptr, bool inStr=false);
+            /** @brief Decodes a base64 string of any length in chunks, same behaviour as readStringChunks() and readBase64() */
+            bool readBase64Chunks(byte* buf, size_t size, const std::function<void(const byte* chunk, size_t len)>& callback, bool inStr=false);
+            /** @brief Decodes a hex string (upper or lower case digits) into a fixed-capacity buffer, same behaviour as readBase64() */
+            bool readHex(byte* buf, size_t size, size_t* length=nullptr, bool inStr=false);
+            /** @brief Decodes a hex string of any length in chunks, same behaviour as readStringChunks() and readHex() */
+            bool readHexChunks(byte* buf, size_t size, const std::function<void(const byte* chunk, size_t len)>& callback, bool inStr=false);
             /**
              * @brief Compares a string with the immediate next string in the stream
              * @param cstr C string to be compared
@@ -127,19 +351,97 @@ namespace JStream {
             /**
              * @brief Parses the next json integer
              * 
-             * Skips leading Whitespaces, stops parsing at any non-numeric chars
+             * Skips leading Whitespaces, stops parsing at any non-numeric chars.
+             * Integers out of the range of long saturate (see parseInt<T>()).
              * 
              * @param defaultVal Default value, if not a single digit could be parsed
              */
             long parseInt(long defaultVal=0);
+            /**
+             * @brief Parses the next json integer into an integer type, e.g. parseInt<int64_t>()
+             * 
+             * Skips leading Whitespaces, stops parsing at any non-numeric chars.
+             * Integers out of the range of T saturate at its minimum/maximum (negative integers at 0 for unsigned types).
+             * 
+             * @param defaultVal Default value, if not a single digit could be parsed
+             * @param overflowed Set to whether the integer was out of range, unless nullptr
+             */
+            template<typename T>
+            T parseInt(typename std::enable_if<std::is_integral<T>::value, T>::type defaultVal=0, bool* overflowed=nullptr) {
+                resume(Op::PARSE_INT);
+
+                if(mPhase == 0) {
+                    beginInt();
+
+                    int c = skipWhitespace();
+                    if(c < 0 && mStarved) {
+                        fail();
+                        return defaultVal;
+                    }
+                    if(c == '-') {
+                        read();
+                        mIntNeg = true;
+                    }
+                    mPhase = 1;
+                }
+
+                if(!accumulateInt<T>() && mStarved) {
+                    fail();
+                    return defaultVal;
+                }
+
+                if(overflowed != nullptr) *overflowed = mIntOverflow;
+                if(!mIntDigits) return defaultVal;
+
+                return intValue<T>();
+            }
             /**
              * @brief Parses the next json number
              * 
-             * Skips leading Whitespaces, stops parsing at any non-numeric chars
+             * Skips leading Whitespaces, stops parsing at any non-numeric chars.
+             * Returns the nearest double (see Internals::toDouble()).
              * 
              * @param defaultVal Default value, if not a single digit could be parsed
              */
             double parseNum(double defaultVal=0.0);
+            /**
+             * @brief Parses the next json number, integers are parsed without floating point arithmetic
+             * 
+             * Skips leading Whitespaces, stops parsing at any non-numeric chars.
+             * Numbers without a fraction and an exponent are INT numbers, unless they don't fit into int64_t.
+             * All other numbers are DOUBLE numbers, same as parseNum().
+             * 
+             * @return The number, its type is NONE if not a single digit could be parsed
+             */
+            Number parseNumber();
+            /**
+             * @brief Parses the next json number as a fixed point number with DECIMALS decimal places, without floating point arithmetic
+             * 
+             * E.g. parseFixed<2>() parses "23.57" into 2357 hundredths. Further decimal places are rounded half away from zero.
+             * Skips leading Whitespaces, stops parsing at any non-numeric chars.
+             * Numbers out of the range of T saturate at its minimum/maximum (negative numbers at 0 for unsigned types).
+             * 
+             * @param defaultVal Default value, if not a single digit could be parsed
+             * @param overflowed Set to whether the number was out of range, unless nullptr
+             */
+            template<unsigned int DECIMALS, typename T=int32_t>
+            T parseFixed(T defaultVal=0, bool* overflowed=nullptr) {
+                static_assert(std::is_integral<T>::value, "fixed point numbers are integers");
+
+                resume(Op::PARSE_FIXED);
+                if(overflowed != nullptr) *overflowed = false;
+                if(!accumulateNum()) return defaultVal;
+
+                typedef typename std::make_unsigned<T>::type U;
+                bool negative = mAcc.sign < 0;
+                U max = static_cast<U>(std::numeric_limits<T>::max());
+                uint64_t limit = negative ? (std::numeric_limits<T>::is_signed ? static_cast<uint64_t>(max) + 1 : 0) : max;
+
+                bool saturated;
+                uint64_t magnitude = mAcc.getScaled(DECIMALS, limit, saturated);
+                if(saturated && overflowed != nullptr) *overflowed = true;
+                return static_cast<T>(negative ? 0 - magnitude : magnitude);
+            }
             /**
              * @brief Parses the next json boolean
              * 
@@ -148,69 +450,452 @@ namespace JStream {
              * @param defaultVal Default value, if no valid boolean could be parsed
              */
             bool parseBool(bool defaultVal=false);
+            /**
+             * @brief Parses the next json string as one of the values of a set (e.g. enum-like values)
+             * 
+             * Skips leading Whitespaces, the string is matched against the set while reading it (see nextKeyOf()).
+             * If the string isn't in the set, it is skipped.
+             * 
+             * @param defaultVal Default value, if no string of the set could be parsed
+             * @return The index of the string in the set
+             */
+            int parseEnum(const KeySet& values, int defaultVal=-1);
             /**
              * @brief Parses an array of integers
-             * If T is an unsigned type, negative integers are ignored
+             * If T is an unsigned type, negative integers are ignored, integers out of the range of T saturate (see parseInt<T>())
              * @param inArray Indicates the opening '[' was alread read
+             * @param overflowed Set to whether any integer was out of range, unless nullptr
              */
             template<typename T>
-            bool parseIntArray(std::vector<T>& vec, bool inArray=false) {
+            bool parseIntArray(std::vector<T>& vec, bool inArray=false, bool* overflowed=nullptr) {
+                return intArray<T>([&vec](T val) { vec.push_back(val); }, inArray, overflowed);
+            }
+            /**
+             * @brief Parses an array of integers into a fixed-capacity buffer, same behaviour as parseIntArray(std::vector<T>&)
+             * 
+             * Elements that don't fit into the buffer are skipped. When parsing incrementally, the same buffer has to be passed to resume the array.
+             * @param buf Buffer of size elements
+             * @param count Receives the number of elements of the array, they were truncated if count > size (optional)
+             */
+            template<typename T>
+            bool parseIntArray(T* buf, size_t size, size_t* count=nullptr, bool inArray=false, bool* overflowed=nullptr) {
+                bool valid = intArray<T>([this, buf, size](T val) {
+                    if(mCount < size) buf[mCount] = val;
+                    mCount++;
+                }, inArray, overflowed);
+                if(count != nullptr) *count = mCount;
+                return valid;
+            }
+            /**
+             * @brief Parses an array of integers of any length in chunks, same behaviour as readStringChunks() and parseIntArray(std::vector<T>&)
+             * 
+             * The callback is called whenever the buffer is full, and once more with the remaining elements at the closing ']'.
+             * @param buf Buffer of size elements, which is the size of each chunk but the last
+             * @param callback Called with each chunk and its number of elements (T is only deduced from buf, so lambdas can be passed)
+             */
+            template<typename T>
+            bool parseIntArrayChunks(T* buf, size_t size, const std::function<void(const typename std::common_type<T>::type* chunk, size_t len)>& callback,
+                bool inArray=false, bool* overflowed=nullptr) {
+                if(size == 0) return false;
+                bool valid = intArray<T>([this, buf, size, &callback](T val) {
+                    buf[mCount++] = val;
+                    if(mCount == size) {
+                        callback(buf, size);
+                        mCount = 0;
+                    }
+                }, inArray, overflowed);
+                if(valid && mCount > 0) callback(buf, mCount);
+                return valid;
+            }
+            /**
+             * @brief Parses an array of json numbers
+             * @param inArray Indicates the opening '[' was alread read
+             */
+            bool parseNumArray(std::vector<double>& vec, bool inArray=false);
+            /**
+             * @brief Parses an array of json numbers into a fixed-capacity buffer, same behaviour as parseIntArray(T*, size_t, size_t*)
+             * @param buf Buffer of size elements
+             * @param count Receives the number of elements of the array, they were truncated if count > size (optional)
+             */
+            bool parseNumArray(double* buf, size_t size, size_t* count=nullptr, bool inArray=false);
+            /** @brief Parses an array of json numbers of any length in chunks, same behaviour as parseIntArrayChunks() */
+            bool parseNumArrayChunks(double* buf, size_t size, const std::function<void(const double* chunk, size_t len)>& callback,
+                bool inArray=false);
+        private:
+            friend struct PathPredicate; // Compares strings with several literals while reading them
+
+            /** @brief Operations that can be suspended when parsing incrementally */
+            enum class Op : byte {
+                NONE, AT_END, NEXT, NEXT_KEY, NEXT_KEY_OF, FIND_KEY, FIND, QUERY, ENTER_COLLECTION, EXIT_COLLECTION, SKIP_COLLECTION,
+                SKIP_STRING, SKIP_VALUE, READ_STRING, STRCMP, PARSE_INT, PARSE_NUM, PARSE_NUMBER, PARSE_FIXED, PARSE_BOOL, PARSE_ENUM,
+                PARSE_INT_ARRAY, PARSE_NUM_ARRAY
+            };
+
+            Stream* mStream = nullptr;
+
+            JsonSource* mSource = nullptr;
+
+            char* mBuf = nullptr; // Read-ahead window of the stream, nullptr if the stream is read char by char
+            size_t mBufSize = 0;
+            const char* mPos = nullptr; // Next unread char in the window
+            const char* mEnd = nullptr; // End of the valid chars in the window
+
+            // Values buffered by walk() until the predicates deciding about them were evaluated
+            std::vector<char> mBuffered;
+            bool mReplaying = false; // The window is a buffered value, the input continues at mReplayPos
+            const char* mReplayPos = nullptr;
+            const char* mReplayEnd = nullptr;
+
+            /** @brief Returns the next char without consuming it, or -1 if the stream ended */
+            int peek() {
+                if(mPos != mEnd) return static_cast<unsigned char>(*mPos);
+                if(mBuf == nullptr && mStream != nullptr) return mStream->peek();
+                return fill() ? static_cast<unsigned char>(*mPos) : -1;
+            }
+            /** @brief Consumes and returns the next char, or -1 if the stream ended */
+            int read() {
+                if(mPos != mEnd) return static_cast<unsigned char>(*mPos++);
+                if(mBuf == nullptr && mStream != nullptr) return mStream->read();
+                return fill() ? static_cast<unsigned char>(*mPos++) : -1;
+            }
+            /**
+             * @brief Refills the window with the next block of the source or the chars currently available in the stream
+             * @return false if no more chars are available
+             */
+            bool fill();
+            /** @brief Continues with the input after the buffered value (see mReplaying) */
+            void endReplay() {
+                mReplaying = false;
+                mPos = mReplayPos;
+                mEnd = mReplayEnd;
+            }
+
+            // Incremental parsing
+            bool mIncremental = false; // Json is fed in chunks
+            bool mInputEnded = false; // No more chunks will be fed
+            bool mStarved = false; // The current operation ran out of input before the json ended
+            Op mOp = Op::NONE; // The current operation
+            Op mSuspended = Op::NONE; // The operation that ran out of input and can be resumed
+
+            // Progress of the current operation
+            byte mPhase = 0; // Operation specific phase, 0 if the operation just started
+            size_t mCount = 0; // Operation specific counter (e.g. matched chars)
+            int mResult = 0; // Operation specific pending result
+            size_t mDepth = 0; // Number of objects/arrays that still have to be exited
+            bool mInStr = false; // A string still has to be exited
+            bool mEscape = false; // The previous char was an unescaped '\\'
+            size_t mRemaining = 0; // Number of values next() still has to skip
+            byte mKeyPhase = 0; // Phase of matching a key
+            size_t mKeyMatched = 0; // Position in the key after the matched chars
+            size_t mKeyNode = 0; // Trie node of the matched chars of a key set (see KeySet)
+            size_t mSegment = 0; // Current path segment of find()
+            Internals::NumAccumulator mAcc;
+            unsigned long long mIntAcc = 0; // Digits of the current integer
+            bool mIntNeg = false; // The current integer is negative
+            bool mIntDigits = false; // The current integer has at least one digit
+            bool mIntOverflow = false; // The current integer is out of range, mIntAcc saturated
+
+            /**
+             * @brief Starts an operation, resumes it if it was suspended
+             * 
+             * If the operation isn't resumed its phase is reset to 0.
+             * @return true if the operation is resumed
+             */
+            bool resume(Op op) {
+                bool resumed = mSuspended == op;
+                mOp = op;
+                mSuspended = Op::NONE;
+                mStarved = false;
+                if(!resumed) mPhase = 0;
+                return resumed;
+            }
+            /** @brief Fails the current operation, suspends it if it ran out of input. Always returns false */
+            bool fail() {
+                if(mStarved) mSuspended = mOp;
+                return false;
+            }
+
+            /** @brief Starts skipping the rest of a string that was already entered */
+            void beginString() {
+                mDepth = 0;
+                mInStr = true;
+                mEscape = false;
+            }
+            /**
+             * @brief Skips chars until all pending strings and objects/arrays (see mInStr, mDepth) are exited
+             * @return false if the input ended before
+             */
+            bool skipPending();
+            /**
+             * @brief Runs the table-driven skipping DFA (see Internals::SKIP_TRANSITIONS)
+             * 
+             * Skips until all pending strings and objects/arrays are exited.
+             * If siblings is true, additionally skips until mRemaining siblings in the current object/array were passed.
+             * @return false if the input ended before, or the current object/array ended before passing the siblings
+             */
+            bool skip(bool siblings);
+
+            /** @brief Starts skipping to the start of the n-th succeeding key/value (see advance()) */
+            void beginNext(size_t n) {
+                mRemaining = n;
+                mDepth = 0;
+                mInStr = false;
+            }
+            /** @brief Continues skipping to the start of the n-th succeeding key/value, same behaviour as next() */
+            bool advance();
+
+            /** @brief Starts searching a key in the current object (see matchKey()) */
+            void beginKey() {
+                mKeyPhase = 0;
+            }
+            /**
+             * @brief Walks json values and visits the values at the paths of a query (see query())
+             * 
+             * Starts by visiting the immediately following value in the given state, or if the query has more frames than base,
+             * at the next member of the innermost frame. Ends once the query has base frames again.
+             * @param callback Called for each visited path, if nullptr the walk stops at the first visited value (see find())
+             * @return true if the walk ended, or find() stopped at a value
+             */
+            bool walk(Query& query, const std::function<void(size_t path)>* callback, size_t state=0, size_t base=0);
+            /**
+             * @brief Walks the buffered members of the innermost frame, that lead anywhere with its matched predicates, and drops the buffered members
+             * 
+             * The buffered values are read before the rest of the input.
+             * @return true if find() stopped at a buffered value, the rest of it is read before the rest of the input then
+             */
+            bool replay(Query& query, const std::function<void(size_t path)>* callback);
+            /**
+             * @brief Appends the next value to mBuffered, unless mBuffered would exceed limit chars
+             * @return false if the value didn't fit, it is skipped then
+             */
+            bool bufferValue(size_t limit);
+            /** @brief Finds the segments of a StaticPath, same behaviour as find(Path&) */
+            bool findStatic(const StaticSegment* segments, size_t count, const char* keys);
+            /**
+             * @brief Continues finding a single segment of a path, the current segment is mSegment
+             * @param offset Offset of OFFSET segments
+             * @param key Key of KEY segments
+             */
+            bool findSegment(PathSegmentType type, size_t offset, const char* key);
+            /**
+             * @brief Continues reading the next key in the current object, same behaviour as nextKey(String*)
+             * @param chars Fixed-capacity buffer of size bytes the key is read into instead, if buf is nullptr (see readChars(char*, size_t))
+             */
+            bool readKey(String* buf, char* chars=nullptr, size_t size=0);
+            /**
+             * @brief Continues searching a key in the current object, same behaviour as findKey()
+             * @param inPath thekey is a key segment within a path string, which is matched in place (see find(const char*))
+             */
+            bool matchKey(const char* thekey, bool inPath=false);
+            /** @brief Continues searching a key of a key set in the current object, same behaviour as nextKeyOf(), the index is stored in mResult */
+            bool matchKeyOf(const KeySet& keys);
+
+            /** @brief Starts matching a string, whose opening '"' was already read, against a key set (see matchString()) */
+            void beginMatch() {
+                mKeyNode = KeySet::ROOT;
+                mInStr = false;
+                mEscape = false;
+            }
+            /**
+             * @brief Continues matching a string against a key set
+             * 
+             * Stores the index of the matched key in mResult, -1 if the string isn't in the set.
+             * Strings that aren't in the set are skipped from their first mismatched char on.
+             * @param skipRest If false, the rest of a mismatched string is left to the caller (mInStr is true then)
+             * @return false if the input ended before the closing '"'
+             */
+            bool matchString(const KeySet& keys, bool skipRest=true);
+
+            /** @brief Continues reading a string, whose opening '"' was already read, into a buffer */
+            bool readChars(String& buf);
+            /** @brief Continues reading a string into a fixed-capacity buffer, mCount is the full length of the string */
+            bool readChars(char* buf, size_t size);
+
+            /** @brief Binary encodings of strings (see readBase64(), readHex()) */
+            enum class Encoding : byte {BASE64, HEX};
+            /**
+             * @brief Decodes a binary string into a fixed-capacity buffer, or in chunks if there is a callback
+             * 
+             * Whole groups of digits are decoded straight from the window, mIntAcc holds the digits of a pending group,
+             * mResult their number and mCount the decoded length.
+             */
+            bool decodeString(Encoding encoding, byte* buf, size_t size, const std::function<void(const byte* chunk, size_t len)>* callback,
+                size_t* length, bool inStr);
+
+            /** @brief Reads a string as a view, same behaviour as readString(StringView&) */
+            bool viewString(StringView& view, bool inStr);
+
+            /**
+             * @brief Continues accumulating a json number in mAcc (see parseNum())
+             * @return false if not a single digit could be parsed, or the input ended (the operation is suspended then)
+             */
+            bool accumulateNum();
+            /** @brief Parses an array of json numbers into a sink, same behaviour as intArray() */
+            template<typename Put>
+            bool numArray(Put put, bool inArray);
+
+            /**
+             * @brief Parses an array of integers into a sink, see parseIntArray()
+             * 
+             * mCount is reset when the array starts, it's left to the sink (e.g. the number of elements).
+             * @param put Called with each element
+             */
+            template<typename T, typename Put>
+            bool intArray(Put put, bool inArray, bool* overflowed) {
                 bool ignoreNeg = !std::numeric_limits<T>::is_signed; // Ignore negatiove integers if type is unsigned
 
-                if(!inArray) {
-                    int c = skipWhitespace();
-                    if(c != '[') return false;
-                    mStream->read();
+                resume(Op::PARSE_INT_ARRAY);
+                if(mPhase == 0) {
+                    if(!inArray) {
+                        int c = skipWhitespace();
+                        if(c != '[') return fail();
+                        read();
+                    }
+                    beginInt();
+                    if(overflowed != nullptr) *overflowed = false;
+                    mCount = 0;
+                    mPhase = 3;
                 }
 
-                T num = 0;
-                T sign = 1;
-
-                bool atLeastOneDigit = false;
                 int c;
                 do {
-                    c = mStream->read();
+                    if(mPhase == 3) { // Start of an element, the plain integers in the window are parsed in batches
+                        if(mPos != mEnd) {
+                            int64_t batch[WINDOW_BATCH];
+                            size_t n;
+                            do {
+                                n = Internals::parseIntegers(mPos, mEnd, batch, WINDOW_BATCH, !ignoreNeg);
+                                for(size_t i = 0; i < n; i++) put(clampInt<T>(batch[i], overflowed));
+                            } while(n == WINDOW_BATCH);
+                        }
+                        mPhase = 1;
+                    }
+
+                    c = peek();
+                    if(mPhase == 1 && Internals::isDecDigit(c)) {
+                        if(!accumulateInt<T>()) break;
+                        continue;
+                    }
+
+                    read();
+                    if(mPhase == 2) { // Skip negative integer
+                        if(c == ',') mPhase = 1;
+                        else if(c == ']') return true;
+                        continue;
+                    }
+
                     switch(c) {
                         case ',':
-                            if(atLeastOneDigit) {
-                                vec.push_back(num*sign); // Save read number
-                                num = 0; // Reset num
-                                atLeastOneDigit = false;
+                            if(mIntDigits) {
+                                put(intValue<T>()); // Save read number
+                                if(mIntOverflow && overflowed != nullptr) *overflowed = true;
                             }
-                            sign = 1;
+                            beginInt(); // Reset num
+                            mPhase = 3;
 
                             break;
                         case ']':
-                            if(atLeastOneDigit) vec.push_back(num*sign);
+                            if(mIntDigits) {
+                                put(intValue<T>());
+                                if(mIntOverflow && overflowed != nullptr) *overflowed = true;
+                            }
                             return true;
                         case '-':
-                            if(ignoreNeg) { // ignore/skip integer
-                                int c;
-                                do {
-                                    c = mStream->read();
-                                    if(c == ',') goto CASE_NEG_END;
-                                    else if(c == ']') return true;
-                                } while(c > 0);
-                                return false;
-                            } else if(!atLeastOneDigit) sign = -1;
-                            CASE_NEG_END:
-                            break;
-                        case  '0': case  '1': case  '2': case  '3': case  '4': case  '5': case  '6': case  '7': case  '8': case  '9':
-                            num = num*10 + c - '0';
-                            atLeastOneDigit = true;
+                            if(ignoreNeg) mPhase = 2; // ignore/skip integer
+                            else if(!mIntDigits) mIntNeg = true;
                             break;
                     }
-                } while(c>0);
+                } while(c>=0);
 
-                return false;
+                return fail();
+            }
+
+            /** @brief Number of elements intArray()/numArray() take from the window at a time (see Internals::parseNumbers()) */
+            static const size_t WINDOW_BATCH = sizeof(void*) > 4 ? 32 : 8; // Bounded stack use on microcontrollers
+            /** @brief Returns an integer of the window in the range of T, it saturates like accumulateInt() */
+            template<typename T>
+            static T clampInt(int64_t val, bool* overflowed) {
+                if(val > 0 && static_cast<uint64_t>(val) > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+                    if(overflowed != nullptr) *overflowed = true;
+                    return std::numeric_limits<T>::max();
+                }
+                if(val < 0 && val < static_cast<int64_t>(std::numeric_limits<T>::min())) {
+                    if(overflowed != nullptr) *overflowed = true;
+                    return std::numeric_limits<T>::min();
+                }
+                return static_cast<T>(val);
             }
+
+            /** @brief Resets the integer accumulator */
+            void beginInt() {
+                mIntAcc = 0;
+                mIntNeg = false;
+                mIntDigits = false;
+                mIntOverflow = false;
+            }
+            /** @brief Returns the value of the integer accumulator, the magnitude is in the range of T (see accumulateInt()) */
+            template<typename T>
+            T intValue() {
+                return static_cast<T>(mIntNeg ? 0 - mIntAcc : mIntAcc);
+            }
+
+            /** @brief Accumulator of integers of type T, the native 32 bits unless T needs more */
+            template<typename T>
+            using IntAcc = typename std::conditional<(sizeof(T) > 4), uint64_t, uint32_t>::type;
             /**
-             * @brief Parses an array of json numbers
-             * @param inArray Indicates the opening '[' was alread read
+             * @brief Continues accumulating the digits of an integer of type T into mIntAcc, until the first other char
+             * 
+             * The magnitude saturates at the limit of T for the sign (mIntOverflow), which is checked against a constant cutoff
+             * instead of dividing. If JSTREAM_SWAR_DIGITS is defined, 64 bit integers take 8 digits at a time from the window.
+             * @return false if the input ended (see peek())
              */
-            bool parseNumArray(std::vector<double>& vec, bool inArray=false);
-        private:
-            Stream* mStream = nullptr;
+            template<typename T>
+            bool accumulateInt() {
+                typedef IntAcc<T> U;
+                constexpr U MAX = static_cast<U>(std::numeric_limits<T>::max());
+                constexpr U MIN = std::numeric_limits<T>::is_signed ? MAX + 1 : 0; // Magnitude of the minimum
+                const U limit = mIntNeg ? MIN : MAX;
+                const U cutoff = mIntNeg ? MIN / 10 : MAX / 10;
+                const unsigned int lastDigit = mIntNeg ? MIN % 10 : MAX % 10;
+
+                U acc = static_cast<U>(mIntAcc);
+                int c;
+                while(true) {
+                #ifdef JSTREAM_SWAR_DIGITS
+                    if(sizeof(U) == 8 && limit > 0) { // Negative integers of unsigned types saturate at their first nonzero digit
+                        // Largest accumulator that can't overflow by taking another 8 digits
+                        const U blockCutoff = mIntNeg ? (MIN - 99999999) / 100000000 : (MAX - 99999999) / 100000000;
+                        uint64_t block;
+                        while(mEnd - mPos >= 8 && acc <= blockCutoff && (memcpy(&block, mPos, 8), Internals::isEightDigits(block))) {
+                            acc = acc*100000000 + Internals::parseEightDigits(block);
+                            mPos += 8;
+                            mIntDigits = true;
+                        }
+                    }
+                #endif
+
+                    if(mPos != mEnd) {
+                        c = static_cast<unsigned char>(*mPos);
+                        if(!Internals::isDecDigit(c)) break;
+                        mPos++;
+                    } else {
+                        c = peek();
+                        if(c < 0 || !Internals::isDecDigit(c)) break;
+                        read();
+                    }
+
+                    unsigned int digit = c - '0';
+                    if(acc < cutoff || (acc == cutoff && digit <= lastDigit)) acc = acc*10 + digit;
+                    else {
+                        acc = limit;
+                        mIntOverflow = true;
+                    }
+                    mIntDigits = true;
+                }
+
+                mIntAcc = acc;
+                return c >= 0;
+            }
 
             /**
              * @brief Reads the stream until the start of the n-th succeeding key/value in the current object/array
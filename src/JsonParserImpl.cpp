@@ -1,229 +1,757 @@
 #include "JsonParser.h"
 #include <Internals/JsonUtils.h>
 #include <Internals/NumAccumulator.h>
+#include <Internals/Scan.h>
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 
 namespace JStream {
+    /** @brief Appends len chars to a String, copying them in chunks since String can only append null-terminated strings */
+    static void append(String& buf, const char* chars, size_t len) {
+        char chunk[64];
+
+        if(len == 0) return;
+        buf.reserve(buf.length() + len);
+        while(len > 0) {
+            size_t chunkLen = len < sizeof(chunk) ? len : sizeof(chunk) - 1;
+            memcpy(chunk, chars, chunkLen);
+            chunk[chunkLen] = '\0';
+            buf += chunk;
+
+            chars += chunkLen;
+            len -= chunkLen;
+        }
+    }
+
+    /** @brief Appends len chars to a fixed-capacity buffer of size bytes at length, as far as they fit, and terminates it */
+    static void append(char* buf, size_t size, size_t& length, const char* chars, size_t len) {
+        if(length + 1 < size) memcpy(buf + length, chars, std::min(len, size - 1 - length));
+        length += len;
+        if(size > 0) buf[std::min(length, size - 1)] = '\0';
+    }
+
+    /** @brief Stores a decoded byte in a fixed-capacity buffer at length, if it fits, or passes the buffer to the callback once it is full */
+    static void putByte(byte* buf, size_t size, size_t& length, const std::function<void(const byte* chunk, size_t len)>* callback, byte b) {
+        if(callback != nullptr) {
+            buf[length % size] = b;
+            if(++length % size == 0) (*callback)(buf, size);
+        } else {
+            if(length < size) buf[length] = b;
+            length++;
+        }
+    }
+
     JsonParser::JsonParser() {}
     JsonParser::JsonParser(Stream& stream) : mStream(&stream) {}
+    JsonParser::JsonParser(Stream& stream, char* buf, size_t bufSize) {
+        parse(stream, buf, bufSize);
+    }
+
+    JsonParser::JsonParser(const char* json, size_t len) {
+        parse(json, len);
+    }
+    JsonParser::JsonParser(JsonSource& source) {
+        parse(source);
+    }
 
     void JsonParser::parse(Stream& stream) {
+        parse(stream, nullptr, 0);
+    }
+
+    void JsonParser::parse(Stream& stream, char* buf, size_t bufSize) {
+        mSource = nullptr;
         mStream = &stream;
+        mBuf = bufSize > 0 ? buf : nullptr;
+        mBufSize = bufSize;
+        mPos = mEnd = mBuf;
+        mIncremental = false;
+        mSuspended = Op::NONE;
+        mReplaying = false;
+    }
+
+    void JsonParser::parse(const char* json, size_t len) {
+        mSource = nullptr;
+        mStream = nullptr;
+        mBuf = nullptr;
+        mBufSize = 0;
+        mPos = json;
+        mEnd = json + len;
+        mIncremental = false;
+        mSuspended = Op::NONE;
+        mReplaying = false;
+    }
+
+    void JsonParser::parse(JsonSource& source) {
+        parse(nullptr, 0);
+        mSource = &source;
+    }
+
+    void JsonParser::parseIncremental() {
+        parse(nullptr, 0);
+        mIncremental = true;
+        mInputEnded = false;
+    }
+
+    void JsonParser::feed(const char* chunk, size_t len) {
+        mPos = chunk;
+        mEnd = chunk + len;
+    }
+
+    void JsonParser::endInput() {
+        mInputEnded = true;
+    }
+
+    bool JsonParser::needsMore() {
+        return mSuspended != Op::NONE;
     }
 
     bool JsonParser::atEnd() {
+        resume(Op::AT_END);
         int c = skipWhitespace();
+        if(c < 0 && mStarved) return fail();
         return c==0 || c==-1 || c == '}' || c == ']';
     }
 
     bool JsonParser::readString(String& buf, bool inStr) {
-        if(!inStr) {
-            int c = skipWhitespace();
-            if(c != '"') return false; 
-            mStream->read(); // Read opening '"'
+        resume(Op::READ_STRING);
+        if(mPhase == 0) {
+            if(!inStr) {
+                int c = skipWhitespace();
+                if(c != '"') return fail();
+                read(); // Read opening '"'
+            }
+            mEscape = false;
+            mPhase = 1;
         }
 
-        int c = mStream->read();
-        while(c >= 0) {
-            if(c == '\\') {
-                c = Internals::escape(mStream->read());
-                if(c == 0) break;
-            } else if (c == '"') return true;
+        return readChars(buf) || fail();
+    }
 
-            buf += (char)c;
-            c = mStream->read();
+    bool JsonParser::readString(char* buf, size_t size, size_t* length, bool inStr) {
+        resume(Op::READ_STRING);
+        if(mPhase == 0) {
+            if(!inStr) {
+                int c = skipWhitespace();
+                if(c != '"') return fail();
+                read(); // Read opening '"'
+            }
+            mEscape = false;
+            mCount = 0;
+            if(size > 0) buf[0] = '\0';
+            mPhase = 1;
         }
 
-        return false; // Stream ended without closing the string
+        if(!readChars(buf, size)) return fail();
+        if(length != nullptr) *length = mCount;
+        return true;
     }
-    
-    int JsonParser::strcmp(const char* cstr, bool inStr) {
-        if(!inStr) {
-            skipWhitespace();
-            if(mStream->read() != '"') return false; // Read opening '"'
-        }
 
-        int c = -1;
-        while(static_cast<unsigned char>(*cstr)) {
-            c = mStream->read();
+    bool JsonParser::readStringChunks(char* buf, size_t size, const std::function<void(const char* chunk, size_t len)>& callback, bool inStr) {
+        resume(Op::READ_STRING);
+        if(size == 0) return false;
+        if(mPhase == 0) {
+            if(!inStr) {
+                int c = skipWhitespace();
+                if(c != '"') return fail();
+                read(); // Read opening '"'
+            }
+            mEscape = false;
+            mCount = 0; // Chars in the buffer
+            mPhase = 1;
+        }
 
-            if(c == '\\') {
-                if(!(c = Internals::escape(mStream->read()))) {
-                    skipString(true);
-                    return 1; // char is unescapeable -> any string is bigger than an incorrect one
+        int c;
+        while(true) {
+            // Copy the escape-free run of the window at once, as far as it fills the buffer
+            if(!mEscape && mPos != mEnd) {
+                const char* run = Internals::findQuoteOrEscape(mPos, mEnd);
+                while(mPos != run) {
+                    size_t len = std::min(static_cast<size_t>(run - mPos), size - mCount);
+                    memcpy(buf + mCount, mPos, len);
+                    mPos += len;
+                    mCount += len;
+                    if(mCount == size) {
+                        callback(buf, size);
+                        mCount = 0;
+                    }
                 }
-            } else if(c == '"') return 1; // stream_stream ended but cstr didn't -> cstr > stream_str
+            }
 
-            if(static_cast<unsigned char>(*cstr) != c) {
-                skipString(true);
-                return static_cast<unsigned char>(*cstr) > c ? 1 : -1;
+            if((c = read()) < 0) return fail(); // Stream ended without closing the string
+
+            if(mEscape) {
+                mEscape = false;
+                c = Internals::escape(c);
+                if(c == 0) return fail(); // Unescapeable char
+            } else if(c == '\\') {
+                mEscape = true;
+                continue;
+            } else if(c == '"') {
+                if(mCount > 0) callback(buf, mCount);
+                return true;
             }
 
-            cstr++;
+            buf[mCount++] = static_cast<char>(c);
+            if(mCount == size) {
+                callback(buf, size);
+                mCount = 0;
+            }
         }
+    }
 
-        c = mStream->read();
-        if(c == '"') return 0;
-        else if(c == -1 || c == 0) return 1;
-        else {
-            skipString(true);
-            return -1;
-        }
+    bool JsonParser::readBase64(byte* buf, size_t size, size_t* length, bool inStr) {
+        return decodeString(Encoding::BASE64, buf, size, nullptr, length, inStr);
     }
 
-    long JsonParser::parseInt(long defaultVal) {
-        long result = 0;    
-        long sign = 1;
-        
-        int c = skipWhitespace();
-        if(c == '-') {
-            mStream->read();
-            c = mStream->peek();
-            sign = -1;
-        }
+    bool JsonParser::readBase64Chunks(byte* buf, size_t size, const std::function<void(const byte* chunk, size_t len)>& callback, bool inStr) {
+        return decodeString(Encoding::BASE64, buf, size, &callback, nullptr, inStr);
+    }
 
-        bool moreThanOneDigit = false;
-        while(c >= 0) {
-            switch(c) {
-                case  '0': case  '1': case  '2': case  '3': case  '4': case  '5': case  '6': case  '7': case  '8': case  '9':
-                    result = result*10 + mStream->read() - '0';
-                    moreThanOneDigit = true;
-                    break;
-                default:
-                    goto END_PARSING;
+    bool JsonParser::readHex(byte* buf, size_t size, size_t* length, bool inStr) {
+        return decodeString(Encoding::HEX, buf, size, nullptr, length, inStr);
+    }
+
+    bool JsonParser::readHexChunks(byte* buf, size_t size, const std::function<void(const byte* chunk, size_t len)>& callback, bool inStr) {
+        return decodeString(Encoding::HEX, buf, size, &callback, nullptr, inStr);
+    }
+
+    bool JsonParser::decodeString(Encoding encoding, byte* buf, size_t size, const std::function<void(const byte* chunk, size_t len)>* callback,
+        size_t* length, bool inStr) {
+        resume(Op::READ_STRING);
+        if(size == 0 && callback != nullptr) return false;
+        if(mPhase == 0) {
+            if(!inStr) {
+                int c = skipWhitespace();
+                if(c != '"') return fail();
+                read(); // Read opening '"'
             }
-            c = mStream->peek();
+            mEscape = false;
+            mCount = 0;
+            mIntAcc = 0;
+            mResult = 0;
+            mPhase = 1; // 2 once the padding started
         }
-        END_PARSING:
 
-        if(!moreThanOneDigit) return defaultVal;
-        
-        return result*sign;
-    }    
+        bool base64 = encoding == Encoding::BASE64;
+        int groupSize = base64 ? 4 : 2;
 
-    double JsonParser::parseNum(double defaultVal) {
-        Internals::NumAccumulator acc;
+        // Decodes the pending digits of a group, that is cut short by padding or the end of the string
+        auto endGroup = [&]() {
+            if(mResult == 0) return true;
+            if(!base64 || mResult == 1) return false; // Doesn't make up a byte
+            putByte(buf, size, mCount, callback, static_cast<byte>(mIntAcc >> (mResult == 2 ? 4 : 10)));
+            if(mResult == 3) putByte(buf, size, mCount, callback, static_cast<byte>(mIntAcc >> 2));
+            mResult = 0;
+            return true;
+        };
 
-        // Determine number sign
-        int c = skipWhitespace();
-        if(c == '-') {
-            mStream->read();
-            c = mStream->peek();
-            acc.sign = -1;
-        }
+        int c;
+        while(true) {
+            // Decode the whole groups of the escape-free run at once
+            while(!mEscape && mResult == 0 && mPhase == 1 && mPos != mEnd) {
+                size_t fill = callback != nullptr ? mCount % size : std::min(mCount, size);
+                const char* run = Internals::findQuoteOrEscape(mPos, mEnd);
+                size_t decoded = base64 ? Internals::decodeBase64(mPos, run, buf + fill, size - fill) : Internals::decodeHex(mPos, run, buf + fill, size - fill);
+                mCount += decoded;
+                if(callback == nullptr || decoded == 0 || mCount % size != 0) break;
+                (*callback)(buf, size);
+            }
 
-        // Parse number
-        while((c = mStream->peek()) >= 0) {
-            switch(c) {
-                case  '0': case  '1': case  '2': case  '3': case  '4': case  '5': case  '6': case  '7': case  '8': case  '9':
-                    acc.addDigitToSegment(mStream->read() - '0');
-                    break;
-                case '.':
-                    if(!acc.segmentHasAtLeastOneDigit) return defaultVal; // Check if prev segment has >=1 digits
+            if((c = read()) < 0) return fail(); // Stream ended without closing the string
+
+            if(mEscape) {
+                mEscape = false;
+                c = Internals::escape(c);
+                if(c == 0) return fail(); // Unescapeable char
+            } else if(c == '\\') {
+                mEscape = true;
+                continue;
+            } else if(c == '"') {
+                if(!endGroup()) return false;
+                if(callback != nullptr && mCount % size != 0) (*callback)(buf, mCount % size);
+                if(length != nullptr) *length = mCount;
+                return true;
+            }
 
-                    mStream->read();
-                    acc.setSegment(Internals::NumAccumulator::NumSegment::DECIMAL);
-                    break;
-                case 'e': case 'E':
-                    if(!acc.segmentHasAtLeastOneDigit) return defaultVal; // Check if prev segment has >=1 digits
+            if(Internals::isWhitespace(c)) continue; // Line breaks of wrapped encodings
 
-                    mStream->read();
-                    acc.setSegment(Internals::NumAccumulator::NumSegment::EXPONENT);
+            if(base64 && c == '=') { // Padding ends the pending group
+                if(!endGroup()) return false;
+                mPhase = 2;
+                continue;
+            }
 
-                    c = skipWhitespace();
+            byte value = base64 ? Internals::base64Value(c) : Internals::hexValue(c);
+            if(value == Internals::NOT_A_DIGIT || mPhase == 2) return false; // Not part of the encoding, or follows the padding
+            mIntAcc = mIntAcc << (base64 ? 6 : 4) | value;
+            if(++mResult == groupSize) {
+                if(base64) {
+                    putByte(buf, size, mCount, callback, static_cast<byte>(mIntAcc >> 16));
+                    putByte(buf, size, mCount, callback, static_cast<byte>(mIntAcc >> 8));
+                }
+                putByte(buf, size, mCount, callback, static_cast<byte>(mIntAcc));
+                mIntAcc = 0;
+                mResult = 0;
+            }
+        }
+    }
 
-                    if(c == '+') mStream->read();
-                    else if(c == '-') {
-                        mStream->read();
-                        acc.expSign = -1;
+    bool JsonParser::readString(StringView& view, bool inStr) {
+        resume(Op::READ_STRING);
+        return viewString(view, inStr) || fail();
+    }
+    
+    int JsonParser::strcmp(const char* cstr, bool inStr) {
+        resume(Op::STRCMP);
+
+        int c;
+        switch(mPhase) {
+            case 0:
+                if(!inStr) {
+                    skipWhitespace();
+                    if(read() != '"') { // Read opening '"'
+                        fail();
+                        return false;
                     }
-                    break;
-                default:
-                    goto END_PARSING;
+                }
+                mCount = 0;
+                mEscape = false;
+                mPhase = 1;
+            case 1:
+                while(static_cast<unsigned char>(cstr[mCount])) {
+                    c = read();
+                    if(c < 0 && mStarved) {
+                        fail();
+                        return 1;
+                    }
+
+                    if(mEscape) {
+                        mEscape = false;
+                        if(!(c = Internals::escape(c))) {
+                            mResult = 1; // char is unescapeable -> any string is bigger than an incorrect one
+                            goto SKIP_REST;
+                        }
+                    } else if(c == '\\') {
+                        mEscape = true;
+                        continue;
+                    } else if(c == '"') return 1; // stream_stream ended but cstr didn't -> cstr > stream_str
+
+                    if(static_cast<unsigned char>(cstr[mCount]) != c) {
+                        mResult = static_cast<unsigned char>(cstr[mCount]) > c ? 1 : -1;
+                        goto SKIP_REST;
+                    }
+
+                    mCount++;
+                }
+
+                c = read();
+                if(c == '"') return 0;
+                else if(c == -1 || c == 0) {
+                    if(mStarved) fail();
+                    return 1;
+                }
+                mResult = -1;
+
+                SKIP_REST:
+                beginString();
+                mPhase = 2;
+            case 2:
+                if(!skipPending() && mStarved) {
+                    fail();
+                    return 1;
+                }
+                return mResult;
+        }
+        return 1;
+    }
+
+    long JsonParser::parseInt(long defaultVal) {
+        return parseInt<long>(defaultVal);
+    }
+
+    double JsonParser::parseNum(double defaultVal) {
+        resume(Op::PARSE_NUM);
+        if(!accumulateNum()) return defaultVal;
+
+        return mAcc.get();
+    }
+
+    Number JsonParser::parseNumber() {
+        resume(Op::PARSE_NUMBER);
+
+        Number number;
+        if(!accumulateNum()) return number;
+
+        // Integral numbers stay integers, unless they don't fit into int64_t
+        if(mAcc.isIntegral()) {
+            bool overflowed;
+            uint64_t limit = static_cast<uint64_t>(INT64_MAX) + (mAcc.sign < 0 ? 1 : 0);
+            uint64_t magnitude = mAcc.getScaled(0, limit, overflowed);
+            if(!overflowed) {
+                number.type = Number::INT;
+                number.integer = static_cast<int64_t>(mAcc.sign < 0 ? 0 - magnitude : magnitude);
+                return number;
             }
         }
-        END_PARSING:
 
-        if(!acc.segmentHasAtLeastOneDigit) return defaultVal;
-        
-        return acc.get();
+        number.type = Number::DOUBLE;
+        number.real = mAcc.get();
+        return number;
     }
 
     bool JsonParser::parseBool(bool defaultVal) {
         static const char* str_true = "true";
         static const char* str_false = "false";
 
-        bool result;
-        char* compareTo;
-        int c = skipWhitespace();
-        if(c == 't') {
-            result = true;
-            compareTo = (char*)str_true + 1;
-        }
-        else if(c == 'f') {
-            result = false;
-            compareTo = (char*)str_false + 1;
-        }
-        else return defaultVal;
+        resume(Op::PARSE_BOOL);
 
-        mStream->read();
+        if(mPhase == 0) {
+            int c = skipWhitespace();
+            if(c == 't') mResult = true;
+            else if(c == 'f') mResult = false;
+            else {
+                fail();
+                return defaultVal;
+            }
 
+            read();
+            mCount = 1;
+            mPhase = 1;
+        }
+
+        const char* compareTo = (mResult ? str_true : str_false) + mCount;
         while(*compareTo) {
-            if(mStream->peek() != static_cast<unsigned char>(*compareTo)) return defaultVal;
-            mStream->read();
+            int c = peek();
+            if(c != static_cast<unsigned char>(*compareTo)) {
+                fail();
+                return defaultVal;
+            }
+            read();
             compareTo++;
+            mCount++;
         }
 
-        return result;
+        return mResult;
     }
 
-    bool JsonParser::parseNumArray(std::vector<double>& vec, bool inArray) {
-        if(!inArray) {
+    int JsonParser::parseEnum(const KeySet& values, int defaultVal) {
+        resume(Op::PARSE_ENUM);
+
+        if(mPhase == 0) {
             int c = skipWhitespace();
+            if(c != '"') {
+                fail();
+                return defaultVal;
+            }
+            read();
 
-            if(c != '[') return false;
-            mStream->read();
+            beginMatch();
+            mPhase = 1;
+        }
+
+        if(!matchString(values)) {
+            fail();
+            return defaultVal;
+        }
+        return mResult < 0 ? defaultVal : mResult;
+    }
+
+    template<typename Put>
+    bool JsonParser::numArray(Put put, bool inArray) {
+        resume(Op::PARSE_NUM_ARRAY);
+
+        if(mPhase == 0) {
+            if(!inArray) {
+                int c = skipWhitespace();
+
+                if(c != '[') return fail();
+                read();
+            }
+
+            mAcc.reset();
+            mCount = 0;
+            mPhase = 3;
         }
 
-        Internals::NumAccumulator acc;
         int c;
         do {
-            c = mStream->read();
+            if(mPhase == 3) { // Start of an element, the plain numbers in the window are parsed in batches
+                if(mPos != mEnd) {
+                    double batch[WINDOW_BATCH];
+                    size_t n;
+                    do {
+                        n = Internals::parseNumbers(mPos, mEnd, batch, WINDOW_BATCH);
+                        for(size_t i = 0; i < n; i++) put(batch[i]);
+                    } while(n == WINDOW_BATCH);
+                }
+                mPhase = 1;
+            }
+            if(mPhase == 2) { // Skip malformed number
+                if(!advance()) return mStarved ? fail() : true;
+                mAcc.setSegment(static_cast<Internals::NumAccumulator::NumSegment>(mResult));
+                mPhase = 1;
+            }
+
+            c = read();
             switch(c) {
                 case ',':
-                    if(acc.segmentHasAtLeastOneDigit) vec.push_back(acc.get()); // Save read number
-                    acc.reset();
+                    if(mAcc.segmentHasAtLeastOneDigit) put(mAcc.get()); // Save read number
+                    mAcc.reset();
+                    mPhase = 3;
                     break;
                 case ']':
-                    if(acc.segmentHasAtLeastOneDigit) vec.push_back(acc.get()); // Save read number
+                    if(mAcc.segmentHasAtLeastOneDigit) put(mAcc.get()); // Save read number
                     return true;
                 case '-':
-                    if(!acc.segmentHasAtLeastOneDigit) {
-                        if(acc.currentSegment == Internals::NumAccumulator::PRE_DECIMAL) acc.sign = -1;
-                        else if(acc.currentSegment == Internals::NumAccumulator::EXPONENT) acc.expSign = -1;
+                    if(!mAcc.segmentHasAtLeastOneDigit) {
+                        if(mAcc.currentSegment == Internals::NumAccumulator::PRE_DECIMAL) mAcc.sign = -1;
+                        else if(mAcc.currentSegment == Internals::NumAccumulator::EXPONENT) mAcc.expSign = -1;
                     }
                     break;
                 case  '0': case  '1': case  '2': case  '3': case  '4': case  '5': case  '6': case  '7': case  '8': case  '9':
-                    acc.addDigitToSegment(c - '0');
+                    mAcc.addDigitToSegment(c - '0');
                     break;
                 case '.':
-                    if(!acc.segmentHasAtLeastOneDigit) {
-                        acc.reset();
-                        if(!next()) return true;
+                    if(!mAcc.segmentHasAtLeastOneDigit) {
+                        mAcc.reset();
+                        beginNext(1);
+                        mResult = Internals::NumAccumulator::NumSegment::DECIMAL;
+                        mPhase = 2;
+                        break;
                     }
-                    acc.setSegment(Internals::NumAccumulator::NumSegment::DECIMAL);
+                    mAcc.setSegment(Internals::NumAccumulator::NumSegment::DECIMAL);
                     break;
                 case 'e': case 'E':
-                    if(!acc.segmentHasAtLeastOneDigit) {
-                        acc.reset();
-                        if(!next()) return true;
+                    if(!mAcc.segmentHasAtLeastOneDigit) {
+                        mAcc.reset();
+                        beginNext(1);
+                        mResult = Internals::NumAccumulator::NumSegment::EXPONENT;
+                        mPhase = 2;
+                        break;
                     }
 
-                    acc.setSegment(Internals::NumAccumulator::NumSegment::EXPONENT);
+                    mAcc.setSegment(Internals::NumAccumulator::NumSegment::EXPONENT);
                     break;
             }
         } while(c >= 0);
 
-        return false;
+        return fail();
+    }
+
+    bool JsonParser::parseNumArray(std::vector<double>& vec, bool inArray) {
+        return numArray([&vec](double val) { vec.push_back(val); }, inArray);
+    }
+
+    bool JsonParser::parseNumArray(double* buf, size_t size, size_t* count, bool inArray) {
+        bool valid = numArray([this, buf, size](double val) {
+            if(mCount < size) buf[mCount] = val;
+            mCount++;
+        }, inArray);
+        if(count != nullptr) *count = mCount;
+        return valid;
+    }
+
+    bool JsonParser::parseNumArrayChunks(double* buf, size_t size, const std::function<void(const double* chunk, size_t len)>& callback,
+        bool inArray) {
+        if(size == 0) return false;
+        bool valid = numArray([this, buf, size, &callback](double val) {
+            buf[mCount++] = val;
+            if(mCount == size) {
+                callback(buf, size);
+                mCount = 0;
+            }
+        }, inArray);
+        if(valid && mCount > 0) callback(buf, mCount);
+        return valid;
+    }
+
+    /////////////
+    // Private //
+    /////////////
+
+    bool JsonParser::accumulateNum() {
+        // Determine number sign
+        int c;
+        if(mPhase == 0) {
+            mAcc.reset();
+
+            c = skipWhitespace();
+            if(c < 0 && mStarved) return fail();
+            if(c == '-') {
+                read();
+                mAcc.sign = -1;
+            }
+            mPhase = 1;
+        }
+
+        // Parse number
+        while(true) {
+            if(mPhase == 2) { // Determine exponent sign
+                c = skipWhitespace();
+                if(c < 0 && mStarved) return fail();
+
+                if(c == '+') read();
+                else if(c == '-') {
+                    read();
+                    mAcc.expSign = -1;
+                }
+                mPhase = 1;
+            }
+
+            c = peek();
+            if(c < 0) {
+                if(mStarved) return fail();
+                break;
+            }
+
+            switch(c) {
+                case  '0': case  '1': case  '2': case  '3': case  '4': case  '5': case  '6': case  '7': case  '8': case  '9':
+                    mAcc.addDigitToSegment(read() - '0');
+                    break;
+                case '.':
+                    if(!mAcc.segmentHasAtLeastOneDigit) return false; // Check if prev segment has >=1 digits
+
+                    read();
+                    mAcc.setSegment(Internals::NumAccumulator::NumSegment::DECIMAL);
+                    break;
+                case 'e': case 'E':
+                    if(!mAcc.segmentHasAtLeastOneDigit) return false; // Check if prev segment has >=1 digits
+
+                    read();
+                    mAcc.setSegment(Internals::NumAccumulator::NumSegment::EXPONENT);
+                    mPhase = 2;
+                    break;
+                default:
+                    goto END_PARSING;
+            }
+        }
+        END_PARSING:
+
+        return mAcc.segmentHasAtLeastOneDigit;
+    }
+
+    bool JsonParser::fill() {
+        if(mReplaying) {
+            endReplay();
+            if(mPos != mEnd) return true;
+        }
+
+        size_t len = 0;
+        if(mSource != nullptr) {
+            len = mSource->nextBlock(mPos);
+        } else if(mBuf != nullptr && mStream != nullptr) {
+            // Only request chars that are already available, readBytes would otherwise block until its timeout
+            int available = mStream->available();
+            if(available <= 0) return false;
+
+            len = mStream->readBytes(mBuf, (size_t)available < mBufSize ? available : mBufSize);
+            mPos = mBuf;
+        } else if(mIncremental && !mInputEnded) {
+            mStarved = true; // The next chunk has to be fed
+        }
+
+        mEnd = mPos + len;
+        return len > 0;
+    }
+
+    bool JsonParser::viewString(StringView& view, bool inStr) {
+        const char* start;
+        if(!inStr) {
+            int c = skipWhitespace();
+            if(c != '"' || mPos == mEnd) return false;
+            start = mPos + 1; // Skip opening '"' without consuming it
+        } else {
+            if(peek() < 0) return false; // Refills an empty window
+            start = mPos;
+        }
+
+        // Search closing '"', escaped chars can't be viewed
+        const char* it = Internals::findQuoteOrEscape(start, mEnd);
+        if(it == mEnd || *it == '\\') return false;
+
+        view.data = start;
+        view.length = it - start;
+        mPos = it + 1; // Consume the string including the closing '"'
+        return true;
+    }
+
+    bool JsonParser::matchString(const KeySet& keys, bool skipRest) {
+        if(!mInStr) {
+            int c;
+            while((c = read()) >= 0) {
+                if(mEscape) { // Escaped char
+                    mEscape = false;
+                    c = Internals::escape(c);
+                    if(c == 0) break; // Unescapable chars can't match
+                } else if(c == '\\') {
+                    mEscape = true;
+                    continue;
+                } else if(c == '"') {
+                    mResult = keys.keyAt(mKeyNode);
+                    return true;
+                }
+
+                mKeyNode = keys.step(mKeyNode, c);
+                if(mKeyNode == KeySet::ROOT) break; // No key continues with c
+            }
+            if(c < 0) return false;
+
+            beginString(); // Skip the rest of the mismatched string
+        }
+
+        mResult = -1;
+        return !skipRest || skipPending();
+    }
+
+    bool JsonParser::readChars(String& buf) {
+        int c;
+        while(true) {
+            // Append the escape-free run of the window at once
+            if(!mEscape && mPos != mEnd) {
+                const char* run = mPos;
+                mPos = Internals::findQuoteOrEscape(mPos, mEnd);
+                append(buf, run, mPos - run);
+            }
+
+            if((c = read()) < 0) return false; // Stream ended without closing the string
+
+            if(mEscape) {
+                mEscape = false;
+                c = Internals::escape(c);
+                if(c == 0) return false; // Unescapeable char
+            } else if(c == '\\') {
+                mEscape = true;
+                continue;
+            } else if(c == '"') return true;
+
+            buf += (char)c;
+        }
+    }
+
+    bool JsonParser::readChars(char* buf, size_t size) {
+        int c;
+        while(true) {
+            // Copy the escape-free run of the window at once
+            if(!mEscape && mPos != mEnd) {
+                const char* run = mPos;
+                mPos = Internals::findQuoteOrEscape(mPos, mEnd);
+                append(buf, size, mCount, run, mPos - run);
+            }
+
+            if((c = read()) < 0) return false; // Stream ended without closing the string
+
+            if(mEscape) {
+                mEscape = false;
+                c = Internals::escape(c);
+                if(c == 0) return false; // Unescapeable char
+            } else if(c == '\\') {
+                mEscape = true;
+                continue;
+            } else if(c == '"') return true;
+
+            char chr = static_cast<char>(c);
+            append(buf, size, mCount, &chr, 1);
+        }
     }
 } // JStream
@@ -1,229 +1,362 @@
 #include "JsonParser.h"
 #include <Internals/JsonUtils.h>
 #include <Internals/NumAccumulator.h>
+#include <Internals/Scan.h>
+#include <algorithm>
+#include <cstring>
 
 namespace JStream {
+    // Phases of matching a key (see JsonParser::matchKey)
+    enum KeyPhase : byte {KEY_START, KEY_MATCH, KEY_COLON, KEY_SKIP, KEY_SKIP_THEN_NEXT, KEY_NEXT};
+    // Phases of nextKey
+    enum NextKeyPhase : byte {NEXT_KEY_START, NEXT_KEY_READ, NEXT_KEY_COLON, NEXT_KEY_NEXT};
+    // Phases of find
+    enum FindPhase : byte {FIND_ENTER, FIND_SEGMENT};
+
+    /**
+     * @brief Returns the char at pos of a key segment within a path string and advances pos past it, 0 at the end of the key
+     *
+     * Same escapes as Path::append(): A '\\' escapes '[', '/', '*' and '.', before other chars it's part of the key itself.
+     */
+    static unsigned char pathKeyChar(const char* key, size_t& pos) {
+        unsigned char c = static_cast<unsigned char>(key[pos]);
+        if(c == '[' || c == '/') return 0;
+        if(c == '\\') {
+            // A '\\' following an odd number of '\\' is the escaped char of the previous one
+            size_t preceding = 0;
+            while(preceding < pos && key[pos - preceding - 1] == '\\') preceding++;
+
+            char next = key[pos + 1];
+            if(preceding % 2 == 0 && (next == '[' || next == '/' || next == '*' || next == '.')) {
+                pos += 2;
+                return next;
+            }
+        }
+        if(c) pos++;
+        return c;
+    }
+
     bool JsonParser::nextVal(size_t n) {
         return next(n);
     }
 
     bool JsonParser::nextKey(String* buf) {
+        if(!resume(Op::NEXT_KEY)) beginKey();
+        return readKey(buf) || fail();
+    }
 
-        skipWhitespace();
-        do {
-            if(mStream->peek() != '"') continue; // not start of a string -> cannot be a key -> try matching next key
-            mStream->read();
-
-            if(buf == nullptr) {
-                if(!skipString(true)) continue;
-            } else {
-                *buf = "";
-                if(!readString(*buf, true)) continue;
+    bool JsonParser::nextKey(char* buf, size_t size, size_t* length) {
+        if(!resume(Op::NEXT_KEY)) beginKey();
+        if(!readKey(nullptr, buf, size)) return fail();
+        if(length != nullptr) *length = mCount;
+        return true;
+    }
+
+    bool JsonParser::nextKey(StringView& key) {
+        resume(Op::NEXT_KEY);
+
+        int c;
+        while(true) {
+            if(mPhase == NEXT_KEY_NEXT) {
+                if(!advance()) return fail();
+                mPhase = NEXT_KEY_START;
             }
 
-            int c = skipWhitespace();
+            if(mPhase == NEXT_KEY_START) {
+                c = skipWhitespace();
+                if(c < 0) return fail();
+                if(c != '"') { // not start of a string -> cannot be a key -> try matching next key
+                    beginNext(1);
+                    mPhase = NEXT_KEY_NEXT;
+                    continue;
+                }
+                if(!viewString(key, false)) return false; // Key can't be viewed, stream is positioned at its opening '"'
+                mPhase = NEXT_KEY_COLON;
+            }
 
+            c = skipWhitespace();
+            if(c < 0 && mStarved) return fail();
             if(c != ':') {
-                if(buf != nullptr) *buf = "";
+                beginNext(1);
+                mPhase = NEXT_KEY_NEXT;
                 continue;
             }
-            mStream->read();
+            read();
 
             skipWhitespace();
             return true;
-        } while(next());
-        
-        return false;
+        }
     }
 
     bool JsonParser::findKey(const char* thekey) {
-        NEXT_KEY:
-        skipWhitespace();
-        do {
-            // Verify start of key 
-            if(mStream->peek() != '"') continue;  // not start of a string -> cannot be a key -> try matching next key
-            mStream->read();
-
-            // Match key and thekey by comparing each char
-            const char* thekey_it = thekey; // iterator over thekey
-            while(static_cast<unsigned char>(*thekey_it)) {
-                int c = mStream->read();
-                if(c < 0) return false; // Stream ended
-
-                if(c == '\\') { // Escape char
-                    c = Internals::escape(mStream->read());
-                    
-                    // Skip current key if char is unescapable
-                    if(c==0) {
-                        skipString(true);
-                        goto NEXT_KEY;
-                    }
-                } else if(c == '"') goto NEXT_KEY; // Unescaped '"' terminates key -> thekey is longer than key -> try matching next key
-
-                // Match key[idx] with thekey[idx]
-                if(c != static_cast<unsigned char>(*thekey_it)) { // key[idx] != thekey[idx] -> key doesn't match thekey
-                    skipString(true);
-                    goto NEXT_KEY;
-                }
-
-                // Advance to next char
-                thekey_it++;
-            }
+        if(!resume(Op::FIND_KEY)) beginKey();
+        return matchKey(thekey) || fail();
+    }
 
-            // Check if matching was sucessful
-            if(*thekey_it != 0 || mStream->peek() != '"') { // len(thekey) =/= len(key) -> one is prefix of the other -> no match
-                skipString(true);
-                continue; // try matching next key
-            } else mStream->read(); // Read closing '"'
+    int JsonParser::nextKeyOf(const KeySet& keys) {
+        if(!resume(Op::NEXT_KEY_OF)) beginKey();
+        if(!matchKeyOf(keys)) {
+            fail();
+            return -1;
+        }
+        return mResult;
+    }
 
-            int c = skipWhitespace(); // Whitespace between key and ':'
+    bool JsonParser::find(Path& path) {
+        if(!resume(Op::FIND)) mSegment = 0;
+        if(!path.isValid) return false;
 
-            if(c != ':') continue; // No ':' after matched string -> not a valid json key -> try matching next key
-            else mStream->read();
+        for(const PathSegment& segment : path) {
+            if(segment.type == PathSegmentType::DESCENDANT || segment.type == PathSegmentType::PREDICATE) { // Matches at any depth or depends on the members, the json has to be walked
+                Query compiled(&path, 1);
+                compiled.mFrames.push_back({0, 0, true, 0, 0, 0, 0}); // Walk the current object/array
+                return walk(compiled, nullptr);
+            }
+        }
 
-            skipWhitespace(); // Whitespace before value (e.g "'key':   123")
+        for(; mSegment<path.size(); mSegment++, mPhase = FIND_ENTER) {
+            const PathSegment& segment = path.at(mSegment);
+            bool key = segment.type == PathSegmentType::KEY;
+            if(!findSegment(segment.type, key ? 0 : segment.val.offset, key ? segment.val.key : nullptr)) return fail();
+        }
+        return true;
+    }
 
-            return true;
-        } while(next());
-        return false;
-    } 
+    bool JsonParser::findStatic(const StaticSegment* segments, size_t count, const char* keys) {
+        if(!resume(Op::FIND)) mSegment = 0;
 
-    bool JsonParser::find(Path& path) {
-        if(!path.isValid) return false;
+        for(; mSegment<count; mSegment++, mPhase = FIND_ENTER) {
+            const StaticSegment& segment = segments[mSegment];
+            bool key = segment.type == PathSegmentType::KEY;
+            if(!findSegment(segment.type, segment.val, key ? keys + segment.val : nullptr)) return fail();
+        }
+        return true;
+    }
 
-        for(auto it=path.begin(); it!=path.end(); ++it) {
-            if(it!=path.begin()) {
-                int c = mStream->peek();
+    bool JsonParser::findSegment(PathSegmentType type, size_t offset, const char* key) {
+        if(mPhase == FIND_ENTER) {
+            if(mSegment > 0) {
+                int c = skipWhitespace(); // Might not have been skipped yet if the previous segment ran out of input
                 if(c != '{' && c != '[') return false;
-                mStream->read();
-            }
-            
-            if(it->type == PathSegmentType::OFFSET) {
-                if(!next(it->val.offset)) return false;
-            } else {
-                if(!findKey(it->val.key)) return false;
+                read();
             }
+
+            if(type == PathSegmentType::OFFSET) beginNext(offset);
+            else if(type == PathSegmentType::ANY_OFFSET) beginNext(0); // First element
+            else beginKey();
+            mPhase = FIND_SEGMENT;
+        }
+
+        switch(type) {
+            case PathSegmentType::OFFSET: case PathSegmentType::ANY_OFFSET:
+                return advance();
+            case PathSegmentType::KEY:
+                return matchKey(key);
+            case PathSegmentType::ANY_KEY: // First key
+                return readKey(nullptr);
+            default: // Matched by walking the json, see find(Path&)
+                return false;
         }
-        return true;
     }
 
     bool JsonParser::find(const char* path) {
-        const char* start = path;
-        while(static_cast<unsigned char>(*path)) { 
-            if(path != start) {
-                int c = mStream->peek();
-                if(c != '{' && c != '[') return false;
-                mStream->read();
+        if(std::strstr(path, "..") || std::strstr(path, "**") || std::strstr(path, "[?")) { // Descendant and predicate segments are matched by walking the json
+            Path compiled(path);
+            return find(compiled);
+        }
+
+        if(!resume(Op::FIND)) mSegment = 0;
+
+        while(static_cast<unsigned char>(path[mSegment])) {
+            const char* it = path + mSegment;
+
+            if(mPhase == FIND_ENTER && it != path) {
+                int c = skipWhitespace(); // Might not have been skipped yet if the previous segment ran out of input
+                if(c < 0 && mStarved) return fail();
+                if(c != '{' && c != '[') return fail();
+                read();
             }
 
-            if(*path == '[') { // array path segment
-               path++;
+            if(*it == '[') { // array path segment
+               it++;
 
-                // Read offset
+                // Read offset, a wildcard finds the first element
                 size_t offset = 0;
-                while(static_cast<unsigned char>(*path)) {
-                    if(Internals::isDecDigit(*path)) {
-                        offset = offset*10 + *path++ - '0';
-                    } else if(*path == ']') {
-                        path++;
+                if(it[0] == '*' && it[1] == ']') it += 2;
+                else while(static_cast<unsigned char>(*it)) {
+                    if(Internals::isDecDigit(*it)) {
+                        offset = offset*10 + *it++ - '0';
+                    } else if(*it == ']') {
+                        it++;
                         break;
-                    }
+                    } else return false; // Not an offset
                 }
 
-                if(!next(offset)) return false;
+                if(mPhase == FIND_ENTER) {
+                    beginNext(offset);
+                    mPhase = FIND_SEGMENT;
+                }
+                if(!advance()) return fail();
 
-                // offset (i.e. '[...]') can only be followed by another offset or the start of a key (i.e. '/') 
-                if(*path && *path != '/' && *path != '[') return false;
+                // offset (i.e. '[...]') can only be followed by another offset or the start of a key (i.e. '/')
+                if(*it && *it != '/' && *it != '[') return false;
             } else { // key path segment
-                if(*path == '/') path++;
-
-                // Read key
-                String keyBuf = "";
-                while(static_cast<unsigned char>(*path)) {
-                    switch(*path) {
-                        case '[':
-                            goto END_READ_KEY;
-                        case '/': 
-                            path++;
-                            goto END_READ_KEY;
-                        case '\\': 
-                            path++;
-                            if(*path != '[' && *path != '/') keyBuf += '\\';
-                        default: 
-                            keyBuf += *path++;
+                if(*it == '/') it++;
+
+                if(it[0] == '*' && (!it[1] || it[1] == '/' || it[1] == '[')) { // Wildcard finds the first key
+                    if(mPhase == FIND_ENTER) {
+                        beginKey();
+                        mPhase = FIND_SEGMENT;
                     }
-                }    
-                END_READ_KEY:
+                    if(!readKey(nullptr)) return fail();
+
+                    mSegment = it + 1 - path;
+                    mPhase = FIND_ENTER;
+                    continue;
+                }
+
+                // Match key in place
+                if(mPhase == FIND_ENTER) {
+                    beginKey();
+                    mPhase = FIND_SEGMENT;
+                }
+                if(!matchKey(it, true)) return fail();
 
-                if(!findKey(keyBuf.c_str())) return false;
+                size_t end = 0;
+                while(pathKeyChar(it, end));
+                it += end;
+                if(*it == '/') it++;
             }
+
+            mSegment = it - path;
+            mPhase = FIND_ENTER;
         }
         return true;
     }
 
+    bool JsonParser::query(Query& query, const std::function<void(size_t path)>& callback) {
+        resume(Op::QUERY);
+        if(!query.isValid) return false;
+
+        query.mFrames.clear();
+        return walk(query, &callback);
+    }
+
+    bool JsonParser::forEach(Path& path, const std::function<void()>& callback) {
+        Query compiled(&path, 1);
+        return query(compiled, [&](size_t) { callback(); });
+    }
+
+    bool JsonParser::forEach(const char* path, const std::function<void()>& callback) {
+        Path compiled(path);
+        return forEach(compiled, callback);
+    }
+
     bool JsonParser::enterArr() {
+        resume(Op::ENTER_COLLECTION);
         int c = skipWhitespace();
-        if(c != '[') return false;
-        mStream->read();
+        if(c != '[') return fail();
+        read();
         return true;
     }
 
     bool JsonParser::enterObj() {
+        resume(Op::ENTER_COLLECTION);
         int c = skipWhitespace();
-        if(c != '{') return false;
-        mStream->read();
+        if(c != '{') return fail();
+        read();
         return true;
     }
-    
+
     bool JsonParser::exitCollection(size_t levels) {
-        if(levels == 0) return true;
+        return skipToDepth(levels);
+    }
+
+    bool JsonParser::skipToDepth(size_t levels) {
+        if(!resume(Op::EXIT_COLLECTION)) {
+            mDepth = levels;
+            mInStr = false;
+        }
+        return skipPending() || fail();
+    }
 
+    bool JsonParser::skipToNextSibling(size_t n) {
+        return next(n);
+    }
+
+    bool JsonParser::skipValue() {
+        using namespace Internals;
+
+        resume(Op::SKIP_VALUE);
         int c;
-        do {
-            c = mStream->read();
-            switch(c) {
-                case '{': case '[':
-                    levels++;
-                    break;
-                case '}': case ']':
-                    if(levels == 1) return true;
-                    levels--;
+        if(mPhase == 0) {
+            c = skipWhitespace();
+            if(c < 0) return fail();
+
+            switch(CHAR_CLASSES[c]) {
+                case CHAR_QUOTE:
+                    read();
+                    beginString();
+                    mPhase = 2;
                     break;
-                case '"':
-                    skipString(true);
+                case CHAR_OPEN:
+                    read();
+                    mDepth = 1;
+                    mInStr = false;
+                    mPhase = 2;
                     break;
+                case CHAR_CLOSE: case CHAR_COMMA: // No value
+                    return false;
+                default: // Number or literal
+                    mPhase = 1;
             }
-        } while(c >= 0);
+        }
 
-        return false;
+        if(mPhase == 1) {
+            // Literals end at the next delimiter or whitespace
+            while((c = peek()) >= 0 && CHAR_CLASSES[c] == CHAR_OTHER && !isWhitespace(c)) read();
+            if(c < 0 && mStarved) return fail();
+        } else if(!skipPending()) return fail();
+
+        skipWhitespace();
+        return true;
     }
 
     bool JsonParser::skipCollection() {
-        int c;
-        do {
-            c = mStream->read();
-            if(c == '[' || c == '{') return exitCollection();
-        } while(c >= 0);
+        if(!resume(Op::SKIP_COLLECTION)) {
+            mDepth = 0;
+            mInStr = false;
+        }
 
-        return false;
-    }
+        if(mDepth == 0 && !mInStr) {
+            int c;
+            do {
+                c = read();
+                if(c == '[' || c == '{') {
+                    mDepth = 1;
+                    break;
+                }
+            } while(c >= 0);
 
-    bool JsonParser::skipString(bool inStr) {
-        if(!inStr) {
-            int c = skipWhitespace();
-            if(c != '"') return false; 
-            mStream->read(); // Read opening '"'
+            if(c < 0) return fail();
         }
 
-        int c = mStream->read();
-        do {
-            if(c == '\\') mStream->read();
-            else if(c == '"') return true;
+        return skipPending() || fail();
+    }
 
-            c = mStream->read();
-        } while(c >= 0);
+    bool JsonParser::skipString(bool inStr) {
+        resume(Op::SKIP_STRING);
+        if(mPhase == 0) {
+            if(!inStr) {
+                int c = skipWhitespace();
+                if(c != '"') return fail();
+                read(); // Read opening '"'
+            }
+            beginString();
+            mPhase = 1;
+        }
 
-        return false; // Stream ended without closing the string
+        return skipPending() || fail(); // Fails if the stream ended without closing the string
     }
 
     /////////////
@@ -231,55 +364,470 @@ namespace JStream {
     /////////////
 
     bool JsonParser::next(size_t n) {
-        if(n == 0) {
-            skipWhitespace();
-            return true;
+        if(!resume(Op::NEXT)) beginNext(n);
+        return advance() || fail();
+    }
+
+    bool JsonParser::advance() {
+        if(!skip(true)) return false;
+
+        skipWhitespace();
+        return true;
+    }
+
+    bool JsonParser::matchKey(const char* thekey, bool inPath) {
+        int c;
+        while(true) {
+            switch(mKeyPhase) {
+                case KEY_START:
+                    // Verify start of key
+                    c = skipWhitespace();
+                    if(c < 0) return false;
+                    if(c != '"') { // not start of a string -> cannot be a key -> try matching next key
+                        beginNext(1);
+                        mKeyPhase = KEY_NEXT;
+                        break;
+                    }
+                    read();
+
+                    mKeyMatched = 0;
+                    mEscape = false;
+                    mKeyPhase = KEY_MATCH;
+                case KEY_MATCH:
+                    // Match key and thekey by comparing each char
+                    while(true) {
+                        size_t next = mKeyMatched;
+                        unsigned char expected = inPath ? pathKeyChar(thekey, next) : static_cast<unsigned char>(thekey[next++]);
+                        if(!expected) break;
+
+                        c = read();
+                        if(c < 0) return false; // Stream ended
+
+                        if(mEscape) { // Escaped char
+                            mEscape = false;
+                            c = Internals::escape(c);
+
+                            // Skip current key if char is unescapable
+                            if(c==0) {
+                                beginString();
+                                mKeyPhase = KEY_SKIP;
+                                break;
+                            }
+                        } else if(c == '\\') {
+                            mEscape = true;
+                            continue;
+                        } else if(c == '"') { // Unescaped '"' terminates key -> thekey is longer than key -> try matching next key
+                            mKeyPhase = KEY_START;
+                            break;
+                        }
+
+                        // Match key[idx] with thekey[idx]
+                        if(c != expected) { // key[idx] != thekey[idx] -> key doesn't match thekey
+                            beginString();
+                            mKeyPhase = KEY_SKIP;
+                            break;
+                        }
+
+                        // Advance to next char
+                        mKeyMatched = next;
+                    }
+                    if(mKeyPhase != KEY_MATCH) break;
+
+                    // Check if matching was sucessful
+                    c = peek();
+                    if(c < 0 && mStarved) return false;
+                    if(c != '"') { // len(thekey) < len(key) -> thekey is prefix of key -> no match
+                        beginString();
+                        mKeyPhase = KEY_SKIP_THEN_NEXT;
+                        break;
+                    }
+                    read(); // Read closing '"'
+
+                    mKeyPhase = KEY_COLON;
+                case KEY_COLON:
+                    c = skipWhitespace(); // Whitespace between key and ':'
+                    if(c < 0 && mStarved) return false;
+
+                    if(c != ':') { // No ':' after matched string -> not a valid json key -> try matching next key
+                        beginNext(1);
+                        mKeyPhase = KEY_NEXT;
+                        break;
+                    }
+                    read();
+
+                    skipWhitespace(); // Whitespace before value (e.g "'key':   123")
+                    return true;
+                case KEY_SKIP:
+                    if(!skipPending()) return false;
+                    mKeyPhase = KEY_START;
+                    break;
+                case KEY_SKIP_THEN_NEXT:
+                    if(!skipPending()) return false;
+                    beginNext(1);
+                    mKeyPhase = KEY_NEXT;
+                case KEY_NEXT:
+                    if(!advance()) return false;
+                    mKeyPhase = KEY_START;
+                    break;
+            }
         }
+    }
 
-        size_t nesting = 0;
+    bool JsonParser::readKey(String* buf, char* chars, size_t size) {
+        int c;
+        while(true) {
+            switch(mKeyPhase) {
+                case NEXT_KEY_START:
+                    c = skipWhitespace();
+                    if(c < 0) return false;
+                    if(c != '"') { // not start of a string -> cannot be a key -> try matching next key
+                        beginNext(1);
+                        mKeyPhase = NEXT_KEY_NEXT;
+                        break;
+                    }
+                    read();
+
+                    if(buf != nullptr) *buf = "";
+                    mCount = 0;
+                    if(chars != nullptr && size > 0) chars[0] = '\0';
+                    beginString();
+                    mKeyPhase = NEXT_KEY_READ;
+                case NEXT_KEY_READ:
+                    if(buf != nullptr ? !readChars(*buf) : chars != nullptr ? !readChars(chars, size) : !skipPending()) {
+                        if(mStarved) return false;
+                        beginNext(1);
+                        mKeyPhase = NEXT_KEY_NEXT;
+                        break;
+                    }
+                    mKeyPhase = NEXT_KEY_COLON;
+                case NEXT_KEY_COLON:
+                    c = skipWhitespace();
+                    if(c < 0 && mStarved) return false;
+
+                    if(c != ':') {
+                        if(buf != nullptr) *buf = "";
+                        mCount = 0;
+                        if(chars != nullptr && size > 0) chars[0] = '\0';
+                        beginNext(1);
+                        mKeyPhase = NEXT_KEY_NEXT;
+                        break;
+                    }
+                    read();
 
-        int c = mStream->peek();
-        while(c >= 0) {
-            switch(c) {
-                case '{': case '[': // Start of a nested object
-                    mStream->read();
-                    exitCollection();
+                    skipWhitespace();
+                    return true;
+                case NEXT_KEY_NEXT:
+                    if(!advance()) return false;
+                    mKeyPhase = NEXT_KEY_START;
                     break;
-                case '}': case ']': // End of current object/array, no next key/value
-                    return false;
-                case '"': // Start of String
-                    skipString();
+            }
+        }
+    }
+
+    bool JsonParser::matchKeyOf(const KeySet& keys) {
+        int c;
+        while(true) {
+            switch(mKeyPhase) {
+                case KEY_START:
+                    c = skipWhitespace();
+                    if(c < 0) return false;
+                    if(c != '"') { // not start of a string -> cannot be a key -> try matching next key
+                        beginNext(1);
+                        mKeyPhase = KEY_NEXT;
+                        break;
+                    }
+                    read();
+
+                    beginMatch();
+                    mKeyPhase = KEY_MATCH;
+                case KEY_MATCH:
+                    if(!matchString(keys)) return false;
+                    if(mResult < 0) { // Unknown key, its value is skipped as a non key
+                        mKeyPhase = KEY_START;
+                        break;
+                    }
+                    mKeyPhase = KEY_COLON;
+                case KEY_COLON:
+                    c = skipWhitespace();
+                    if(c < 0 && mStarved) return false;
+
+                    if(c != ':') { // No ':' after matched string -> not a valid json key -> try matching next key
+                        beginNext(1);
+                        mKeyPhase = KEY_NEXT;
+                        break;
+                    }
+                    read();
+
+                    skipWhitespace();
+                    return true;
+                case KEY_NEXT:
+                    if(!advance()) return false;
+                    mKeyPhase = KEY_START;
                     break;
-                case ',':
-                    mStream->read();
-                    if(nesting > 0) break;
-                        
-                    // Reached start of next key/value
-                    n--;
-                    if(n == 0) {
-                        skipWhitespace();
-                        return true;
+            }
+        }
+    }
+
+    bool JsonParser::walk(Query& query, const std::function<void(size_t path)>* callback, size_t state, size_t base) {
+        std::vector<Query::Frame>& frames = query.mFrames;
+        size_t maxFrames = query.maxDepth + (callback == nullptr); // The current object/array of find() isn't walked below
+        frames.reserve(maxFrames);
+
+        if(base == 0) {
+            query.mCandidates.clear();
+            if(mReplaying && mPos == mEnd) endReplay(); // A value buffered by a previous walk was read completely
+            if(!mReplaying) mBuffered.clear();
+        }
+
+        bool visit = frames.size() == base;
+        while(true) {
+            // Visit the current value
+            if(visit) {
+                int c = skipWhitespace();
+                if(c < 0) return false;
+
+                const Query::State& current = query.mStates[state];
+                if(!current.paths.empty() && callback == nullptr) return true; // find() stops at the first match
+                for(size_t path : current.paths) (*callback)(path);
+
+                c = skipWhitespace();
+                if(current.descend && (c == '{' || c == '[') && frames.size() < maxFrames) {
+                    read();
+                    frames.push_back({state, 0, c == '{', 0, 0, 0, query.mCandidates.size()});
+                } else if(c >= 0 && !skipValue() && peek() < 0) return false; // Rest of the value, unless the callbacks read it
+            }
+            visit = true;
+
+            // Find the next member of the walked objects/arrays
+            while(true) {
+                if(frames.size() == base) return callback != nullptr;
+                Query::Frame& frame = frames.back();
+                const Query::State& parent = query.mStates[frame.state];
+
+                int c = skipWhitespace();
+                if(c < 0) return false;
+                if(c == ',') {
+                    read();
+                    frame.index++;
+                    continue;
+                }
+
+                // Only the listed offsets lead anywhere, skip to the next one or out of the object/array
+                auto offset = parent.offsets.end();
+                bool listedOnly = query.unlisted(frame.state, Query::NO_KEY) == Query::NO_STATE
+                    && (!frame.object || (parent.keys.size() == 0 && query.unlisted(frame.state, Query::KEY_UNKNOWN) == Query::NO_STATE));
+                if(listedOnly) offset = std::lower_bound(parent.offsets.begin(), parent.offsets.end(), frame.index);
+
+                if(c == '}' || c == ']'
+                    || (frame.object && parent.allKeys != 0 && frame.seen == parent.allKeys) // All keys leading anywhere were visited
+                    || (listedOnly && offset == parent.offsets.end())) {
+                    // Predicates that weren't evaluated didn't match
+                    if(frame.candidates < query.mCandidates.size() && replay(query, callback)) return true;
+
+                    if(callback == nullptr && frames.size() == 1) { // find() fails at the closing ']'/'}' of the current object/array
+                        beginNext(static_cast<size_t>(-1));
+                        advance();
+                        return false;
                     }
-                    
+
+                    if(c == '}' || c == ']') read();
+                    else {
+                        mDepth = 1;
+                        mInStr = false;
+                        if(!skipPending()) return false;
+                    }
+                    frames.pop_back();
+                    continue;
+                }
+                if(listedOnly && *offset > frame.index) {
+                    beginNext(*offset - frame.index);
+                    advance(); // Stops at the closing ']'/'}' if there are less members
+                    frame.index = *offset;
+                    continue;
+                }
+
+                // Members of objects are key-value pairs, other members are treated like array elements
+                int key = Query::NO_KEY;
+                if(frame.object && c == '"') {
+                    read();
+                    beginMatch();
+                    if(!matchString(parent.keys, false)) return false;
+                    key = mResult;
+
+                    if(mInStr) { // Unknown key, the rest of it wasn't read yet
+                        if(query.target(frame.state, key, frame.index, parent.allPredicates()) == Query::NO_STATE) {
+                            // Skip the rest of the key, its value and the following ',' at once
+                            mRemaining = 1;
+                            if(advance()) frame.index++;
+                            continue;
+                        }
+                        if(!skipPending()) return false;
+                    }
+
+                    c = skipWhitespace();
+                    if(c != ':') { // not a key-value pair -> skip it
+                        beginNext(1);
+                        if(advance()) frame.index++;
+                        continue;
+                    }
+                    read();
+                }
+
+                state = query.target(frame.state, key, frame.index, frame.matched);
+
+                byte pending = parent.allPredicates() & ~frame.known;
+                if(pending != 0) {
+                    // Members compared by pending predicates are evaluated instead of walked
+                    byte compared = 0;
+                    for(size_t i = 0; i < parent.predicates.size(); i++) {
+                        if((pending & (1U << i)) && parent.predicateKeys[i] == key) compared |= 1U << i;
+                    }
+                    if(compared != 0) {
+                        frame.matched |= PathPredicate::matches(parent.predicates.data(), parent.predicates.size(), compared, *this);
+                        frame.known |= compared;
+                        if(parent.allKeys != 0) frame.seen |= 1UL << key; // Otherwise the key may exceed the mask
+
+                        if(frame.known == parent.allPredicates() && frame.candidates < query.mCandidates.size() && replay(query, callback)) return true;
+                        continue;
+                    }
+
+                    // Members that only lead anywhere if a pending predicate matches are buffered until it was evaluated
+                    if(state == Query::NO_STATE && !mReplaying && query.target(frame.state, key, frame.index, frame.matched | pending) != Query::NO_STATE) {
+                        size_t start = mBuffered.size();
+                        if(bufferValue(query.bufferSize)) query.mCandidates.push_back({key, frame.index, start, mBuffered.size() - start});
+                        if(key >= 0 && parent.allKeys != 0) frame.seen |= 1UL << key;
+                        continue;
+                    }
+                }
+
+                if(state != Query::NO_STATE) {
+                    if(key >= 0 && parent.allKeys != 0) frame.seen |= 1UL << key;
                     break;
-                default: mStream->read();
+                }
+
+                // The member leads nowhere, skip it together with the following ','
+                beginNext(1);
+                if(advance()) frame.index++;
             }
+        }
+    }
 
-            c = mStream->peek();
+    bool JsonParser::replay(Query& query, const std::function<void(size_t path)>* callback) {
+        std::vector<Query::Frame>& frames = query.mFrames;
+        size_t base = frames.size();
+        size_t first = frames.back().candidates;
+
+        for(size_t i = first; i < query.mCandidates.size(); i++) {
+            const Query::Candidate& candidate = query.mCandidates[i];
+            const Query::Frame& frame = frames[base - 1];
+            size_t state = query.target(frame.state, candidate.key, candidate.index, frame.matched);
+            if(state == Query::NO_STATE) continue;
+
+            mReplayPos = mPos;
+            mReplayEnd = mEnd;
+            mPos = mBuffered.data() + candidate.start;
+            mEnd = mPos + candidate.length;
+            mReplaying = true;
+            if(walk(query, callback, state, base) && callback == nullptr) return true;
+
+            frames.resize(base);
+            if(mReplaying) endReplay();
         }
 
-        // Stream ended, no next key/value
+        mBuffered.resize(query.mCandidates[first].start);
+        query.mCandidates.resize(first);
         return false;
     }
 
+    bool JsonParser::bufferValue(size_t limit) {
+        using namespace Internals;
+
+        if(!mReplaying && mBuffered.capacity() < limit) mBuffered.reserve(limit); // Buffered values are never moved while they are read
+        limit = std::min(limit, mBuffered.capacity());
+        size_t start = mBuffered.size();
+        bool fits = true;
+
+        int c = skipWhitespace();
+        if(c < 0 || CHAR_CLASSES[c] == CHAR_CLOSE || CHAR_CLASSES[c] == CHAR_COMMA) return true; // No value
+
+        bool scalar = CHAR_CLASSES[c] == CHAR_OTHER; // Ends at the first delimiter, other values at their closing char
+        byte state = SKIP_OUTSIDE;
+        size_t depth = 0;
+        do {
+            read();
+            if(mBuffered.size() < limit) mBuffered.push_back(static_cast<char>(c));
+            else fits = false;
+
+            byte transition = SKIP_TRANSITIONS[state][CHAR_CLASSES[c]];
+            state = transition & 0x0F;
+            if(transition >> 4 == ACTION_OPEN) depth++;
+            else if(transition >> 4 == ACTION_CLOSE) depth--;
+
+            c = peek();
+        } while(c >= 0 && (scalar ? CHAR_CLASSES[c] == CHAR_OTHER && !isWhitespace(c) : state != SKIP_OUTSIDE || depth > 0));
+
+        if(!fits) mBuffered.resize(start);
+        return fits;
+    }
+
+    bool JsonParser::skipPending() {
+        return skip(false);
+    }
+
+    bool JsonParser::skip(bool siblings) {
+        using namespace Internals;
+
+        byte state = mInStr ? (mEscape ? SKIP_ESCAPE : SKIP_STRING) : SKIP_OUTSIDE;
+        while(state != SKIP_OUTSIDE || mDepth > 0 || (siblings && mRemaining > 0)) {
+            bool top = state == SKIP_OUTSIDE && mDepth == 0; // Between the siblings, chars have to be peeked
+
+            // Skip nested values within the window without looking at every char
+            if(!top && mPos != mEnd) {
+                mInStr = state != SKIP_OUTSIDE;
+                mEscape = state == SKIP_ESCAPE;
+                mPos = skipNested(mPos, mEnd, mDepth, mInStr, mEscape);
+                state = mInStr ? (mEscape ? SKIP_ESCAPE : SKIP_STRING) : SKIP_OUTSIDE;
+                continue;
+            }
+
+            int c = top ? peek() : read();
+            if(c < 0) break;
+
+            byte transition = SKIP_TRANSITIONS[state][CHAR_CLASSES[c]];
+            state = transition & 0x0F;
+            switch(transition >> 4) {
+                case ACTION_OPEN:
+                    mDepth++;
+                    break;
+                case ACTION_CLOSE:
+                    if(mDepth == 0) { // End of current object/array, no next sibling
+                        mInStr = false;
+                        return false;
+                    }
+                    mDepth--;
+                    break;
+                case ACTION_COMMA:
+                    if(mDepth == 0) mRemaining--; // Reached start of next sibling
+                    break;
+            }
+            if(top) read();
+        }
+
+        mInStr = state != SKIP_OUTSIDE;
+        mEscape = state == SKIP_ESCAPE;
+        return state == SKIP_OUTSIDE && mDepth == 0 && !(siblings && mRemaining > 0); // Stream ended otherwise
+    }
+
     int JsonParser::skipWhitespace() {
         int c;
         do {
-            c = mStream->peek();
+            if(mPos != mEnd && Internals::isWhitespace(*mPos)) mPos = Internals::findNonWhitespace(mPos + 1, mEnd);
+
+            c = peek();
             if(!Internals::isWhitespace(c)) break;
-            mStream->read();
+            read();
         } while(c >= 0);
 
         return c;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace JStream {
+    /**
+     * @brief Input that provides json to a JsonParser in blocks
+     * 
+     * The parser scans each block in place and only calls the source again once the block is used up.
+     * Implement this interface to parse json from inputs that aren't a Stream (e.g. files, ring buffers, decompressors).
+     */
+    class JsonSource {
+        public:
+            virtual ~JsonSource() {}
+
+            /**
+             * @brief Provides the next block of json
+             * 
+             * @param block Is set to the first char of the block. The block has to stay valid until the next call.
+             * @return size_t Length of the block, 0 if the json ended
+             */
+            virtual size_t nextBlock(const char*& block) = 0;
+    };
+} // JStream
@@ -0,0 +1,51 @@
+#include "KeySet.h"
+
+namespace JStream {
+
+    KeySet::KeySet(std::initializer_list<const char*> keys) {
+        mNodes.push_back({0, -1, ROOT, ROOT});
+        for(const char* key : keys) add(key);
+    }
+
+    KeySet::KeySet(const char* const* keys, size_t count) {
+        mNodes.push_back({0, -1, ROOT, ROOT});
+        for(size_t i = 0; i < count; i++) add(keys[i]);
+    }
+
+    int KeySet::indexOf(const char* key) const {
+        size_t node = ROOT;
+        for(; *key; key++) {
+            node = step(node, static_cast<unsigned char>(*key));
+            if(node == ROOT) return -1;
+        }
+        return keyAt(node);
+    }
+
+    void KeySet::add(const char* key) {
+        int index = static_cast<int>(mCount++);
+
+        size_t node = ROOT;
+        for(; *key; key++) {
+            unsigned char c = static_cast<unsigned char>(*key);
+
+            // Find the edge labeled with c, children are sorted by their char
+            size_t prev = ROOT;
+            size_t child = mNodes[node].child;
+            while(child != ROOT && mNodes[child].c < c) {
+                prev = child;
+                child = mNodes[child].sibling;
+            }
+
+            if(child == ROOT || mNodes[child].c != c) { // Insert a new node between prev and child
+                mNodes.push_back({c, -1, ROOT, child});
+                size_t inserted = mNodes.size() - 1;
+                if(prev == ROOT) mNodes[node].child = inserted;
+                else mNodes[prev].sibling = inserted;
+                child = inserted;
+            }
+            node = child;
+        }
+
+        if(mNodes[node].key < 0) mNodes[node].key = index; // Duplicate keys keep the first index
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <initializer_list>
+#include <stddef.h>
+
+namespace JStream
+{
+    /**
+     * @brief Precompiled set of keys that can be matched while streaming (see JsonParser::nextKeyOf())
+     *
+     * The keys are stored in a trie, which is built once when constructing the set.
+     * Matching a key walks the trie char by char, without buffering the key or allocating memory.
+     * The index of a key is its position in the list the set was constructed from.
+     */
+    class KeySet {
+        public:
+            KeySet(std::initializer_list<const char*> keys);
+            KeySet(const char* const* keys, size_t count);
+
+            /** @brief Number of keys in the set */
+            size_t size() const { return mCount; }
+
+            /** @brief Returns the index of the given key, or -1 if it isn't in the set */
+            int indexOf(const char* key) const;
+
+            /** @brief Trie node that is reached from the root, it is never the child of another node */
+            static const size_t ROOT = 0;
+
+            /**
+             * @brief Follows the edge labeled with c from the given trie node
+             * @return The reached node, or ROOT if no key continues with c
+             */
+            size_t step(size_t node, unsigned char c) const {
+                for(size_t child = mNodes[node].child; child != ROOT; child = mNodes[child].sibling) {
+                    if(mNodes[child].c >= c) return mNodes[child].c == c ? child : ROOT;
+                }
+                return ROOT;
+            }
+            /** @brief Returns the index of the key ending at the given trie node, or -1 if no key ends there */
+            int keyAt(size_t node) const {
+                return mNodes[node].key;
+            }
+        private:
+            struct Node {
+                unsigned char c; // Char of the edge leading to the node
+                int key; // Index of the key ending at the node, -1 if none
+                size_t child; // First child, ROOT if none
+                size_t sibling; // Next sibling with a greater char, ROOT if none
+            };
+
+            std::vector<Node> mNodes; // Trie, the root is the first node
+            size_t mCount = 0;
+
+            void add(const char* key);
+    };
+} // JStream
@@ -1,9 +1,190 @@
 #include "Path.h"
+#include "JsonParser.h"
 #include <Internals/JsonUtils.h>
 #include <cstring>
+#include <cstdlib>
+#include <new>
 
 namespace JStream {
 
+    namespace {
+        /** @brief Receives the segments of a parsed path, or only counts them if it has no memory (see Path::append()) */
+        struct PathWriter {
+            PathPredicate* predicates;
+            PathSegment* segments;
+            char* chars;
+            size_t predicateCount;
+            size_t segmentCount;
+            size_t charCount;
+
+            void push(const PathSegment& segment) {
+                if(segments) segments[segmentCount] = segment;
+                segmentCount++;
+            }
+            void put(char c) {
+                if(chars) chars[charCount] = c;
+                charCount++;
+            }
+            /** @brief Appends a key from the chars put since start */
+            void pushKey(size_t start) {
+                PathSegment segment(chars ? chars + start : "", charCount - start);
+                put('\0');
+                push(segment);
+            }
+            /** @brief Returns the next predicate, nullptr if the predicates are only counted */
+            PathPredicate* nextPredicate() {
+                return predicates ? new(predicates + predicateCount++) PathPredicate() : (predicateCount++, nullptr);
+            }
+        };
+
+        /** @brief Reads a predicate (e.g. "?key==\"val\"]") including the closing ']', it is only validated if predicate is nullptr */
+        bool readPredicate(const char*& str, PathPredicate* predicate) {
+            str++; // '?'
+
+            // Read key
+            const char* start = str;
+            while(*str && *str != '=' && *str != '!' && *str != '<' && *str != '>') {
+                if(*str == '\\' && str[1]) str++;
+                if(predicate) predicate->key += *str;
+                str++;
+            }
+            if(str == start || !*str) return false;
+
+            // Read operator
+            PredicateOp op;
+            bool orEqual = str[1] == '=';
+            switch(*str) {
+                case '=': if(!orEqual) return false; op = PredicateOp::EQ; break;
+                case '!': if(!orEqual) return false; op = PredicateOp::NE; break;
+                case '<': op = orEqual ? PredicateOp::LE : PredicateOp::LT; break;
+                case '>': op = orEqual ? PredicateOp::GE : PredicateOp::GT; break;
+                default: return false;
+            }
+            str += orEqual ? 2 : 1;
+
+            // Read literal
+            PathPredicate::Kind kind;
+            double number = 0;
+            if(*str == '"' || *str == '\'') {
+                char quote = *str++;
+                while(*str != quote) {
+                    if(!*str) return false;
+                    if(*str == '\\' && str[1]) str++;
+                    if(predicate) predicate->text += *str;
+                    str++;
+                }
+                str++;
+                kind = PathPredicate::STRING;
+            } else {
+                start = str;
+                while(*str && *str != ']') {
+                    if(predicate) predicate->text += *str;
+                    str++;
+                }
+
+                size_t len = str - start;
+                if((len == 4 && std::strncmp(start, "true", 4) == 0) || (len == 5 && std::strncmp(start, "false", 5) == 0)
+                    || (len == 4 && std::strncmp(start, "null", 4) == 0)) {
+                    if(op != PredicateOp::EQ && op != PredicateOp::NE) return false; // Not ordered
+                    kind = PathPredicate::TOKEN;
+                } else {
+                    char* end;
+                    number = std::strtod(start, &end);
+                    if(end == start || end != str) return false; // Not a number
+                    kind = PathPredicate::NUMBER;
+                }
+            }
+
+            if(*str != ']') return false;
+            str++;
+
+            if(predicate) {
+                predicate->op = op;
+                predicate->kind = kind;
+                predicate->number = number;
+            }
+            return true;
+        }
+
+        /** @brief Parses a path with the formatting of Path::append() */
+        bool parsePath(const char* path_str, PathWriter& out) {
+            while(*path_str) {
+                if(path_str[0] == '.' && path_str[1] == '.') { // descendant, any depth
+                    path_str += 2;
+                    out.push(PathSegment(PathSegmentType::DESCENDANT));
+                } else if(*path_str == '[') { // array path segment
+                    path_str++;
+
+                    if(path_str[0] == '*' && path_str[1] == ']') { // wildcard, any element
+                        path_str += 2;
+                        out.push(PathSegment(PathSegmentType::ANY_OFFSET));
+                    } else if(*path_str == '?') { // predicate, any element with a matching member
+                        PathPredicate* predicate = out.nextPredicate();
+                        if(!readPredicate(path_str, predicate)) return false;
+                        out.push(predicate ? PathSegment(*predicate) : PathSegment(PathSegmentType::PREDICATE));
+                    } else {
+                        // Read offset
+                        size_t offset = 0;
+                        while(*path_str) {
+                            if(Internals::isDecDigit(*path_str)) {
+                                offset = offset*10 + *path_str++ - '0';
+                            } else if(*path_str == ']') {
+                                path_str++;
+                                break;
+                            } else return false; // Not an offset
+                        }
+
+                        out.push(PathSegment(offset));
+                    }
+
+                    // offset (i.e. '[...]') can only be followed by another offset or the start of a key (i.e. '/' or '..')
+                    if(*path_str && *path_str != '/' && *path_str != '[' && !(path_str[0] == '.' && path_str[1] == '.')) return false;
+                } else { // key path segment
+                    if(*path_str == '/') path_str++;
+
+                    // wildcards, any key ('*') or any depth ('**')
+                    size_t stars = path_str[0] == '*' ? (path_str[1] == '*' ? 2 : 1) : 0;
+                    char next = path_str[stars];
+                    if(stars && (!next || next == '/' || next == '[' || (next == '.' && path_str[stars + 1] == '.'))) {
+                        path_str += stars;
+                        out.push(PathSegment(stars == 1 ? PathSegmentType::ANY_KEY : PathSegmentType::DESCENDANT));
+                        continue;
+                    }
+
+                    // Read key
+                    size_t start = out.charCount;
+                    while(*path_str) {
+                        switch(*path_str) {
+                            case '[':
+                                goto END_READ_KEY;
+                            case '/':
+                                path_str++;
+                                goto END_READ_KEY;
+                            case '.':
+                                if(path_str[1] == '.') goto END_READ_KEY;
+                                out.put(*path_str++);
+                                break;
+                            case '\\':
+                                path_str++;
+                                if(!*path_str) return false;
+                                if(*path_str != '[' && *path_str != '/' && *path_str != '*' && *path_str != '.') out.put('\\');
+                            default:
+                                out.put(*path_str++);
+                        }
+                    }
+                    END_READ_KEY:
+
+                    out.pushKey(start);
+                }
+            }
+            return true;
+        }
+
+        size_t alignUp(size_t size, size_t alignment) {
+            return (size + alignment - 1) / alignment * alignment;
+        }
+    }
+
     ////////////
     /// Path ///
     ////////////
@@ -12,55 +193,72 @@ namespace JStream {
         isValid = append(path_str);
     }
 
-    Path::Path(const char* path_str, size_t n) {
-        reserve(n);
-        isValid = append(path_str);
+    Path::Path(const char* path_str, size_t) : Path(path_str) {}
+
+    Path::Path(Path&& other) noexcept
+        : isValid(other.isValid), mBlock(other.mBlock), mSegments(other.mSegments), mSize(other.mSize), mPredicates(other.mPredicates), mChars(other.mChars) {
+        other.mBlock = nullptr;
+        other.mSegments = nullptr;
+        other.mSize = other.mPredicates = other.mChars = 0;
+    }
+
+    Path& Path::operator=(Path&& other) noexcept {
+        if(this != &other) {
+            release();
+            isValid = other.isValid;
+            mBlock = other.mBlock;
+            mSegments = other.mSegments;
+            mSize = other.mSize;
+            mPredicates = other.mPredicates;
+            mChars = other.mChars;
+            other.mBlock = nullptr;
+            other.mSegments = nullptr;
+            other.mSize = other.mPredicates = other.mChars = 0;
+        }
+        return *this;
+    }
+
+    Path::~Path() {
+        release();
+    }
+
+    void Path::release() {
+        PathPredicate* predicates = reinterpret_cast<PathPredicate*>(mBlock);
+        for(size_t i = 0; i < mPredicates; i++) predicates[i].~PathPredicate();
+        delete[] mBlock;
     }
 
     bool Path::append(const char* path_str) {
-        while(*path_str) { 
-            if(*path_str == '[') { // array path segment
-               path_str++;
-
-                // Read offset
-                size_t offset = 0;
-                while(*path_str) {
-                    if(Internals::isDecDigit(*path_str)) {
-                        offset = offset*10 + *path_str++ - '0';
-                    } else if(*path_str == ']') {
-                        path_str++;
-                        break;
-                    }
-                }
+        // Count the segments, so the block can be allocated at once
+        PathWriter counter = {nullptr, nullptr, nullptr, mPredicates, mSize, mChars};
+        if(!parsePath(path_str, counter)) return false;
+        if(counter.segmentCount == mSize) return true;
 
-                push_back(PathSegment(offset));
-
-                // offset (i.e. '[...]') can only be followed by another offset or the start of a key (i.e. '/') 
-                if(*path_str && *path_str != '/' && *path_str != '[') return false;
-            } else { // key path segment
-                if(*path_str == '/') path_str++;
-
-                // Read key
-                String keyBuf = "";
-                while(*path_str) {
-                    switch(*path_str) {
-                        case '[':
-                            goto END_READ_KEY;
-                        case '/': 
-                            path_str++;
-                            goto END_READ_KEY;
-                        case '\\': 
-                            path_str++;
-                            if(*path_str != '[' && *path_str != '/') keyBuf += '\\';
-                        default: 
-                            keyBuf += *path_str++;
-                    }
-                }    
-                END_READ_KEY:
+        size_t segmentsStart = alignUp(counter.predicateCount * sizeof(PathPredicate), alignof(PathSegment));
+        size_t charsStart = segmentsStart + counter.segmentCount * sizeof(PathSegment);
+        char* block = new char[charsStart + counter.charCount];
+        PathWriter out = {reinterpret_cast<PathPredicate*>(block), reinterpret_cast<PathSegment*>(block + segmentsStart), block + charsStart,
+            mPredicates, mSize, mChars};
 
-                push_back(PathSegment(keyBuf.c_str(), keyBuf.length()));
-            }
+        // Move the previous segments into the new block
+        PathPredicate* predicates = reinterpret_cast<PathPredicate*>(mBlock);
+        const char* chars = reinterpret_cast<const char*>(mSegments + mSize);
+        for(size_t i = 0; i < mPredicates; i++) new(out.predicates + i) PathPredicate(static_cast<PathPredicate&&>(predicates[i]));
+        if(mChars > 0) std::memcpy(out.chars, chars, mChars);
+        for(size_t i = 0; i < mSize; i++) {
+            PathSegment segment = mSegments[i];
+            if(segment.type == PathSegmentType::KEY) segment.val.key = out.chars + (segment.val.key - chars);
+            else if(segment.type == PathSegmentType::PREDICATE) segment.val.predicate = out.predicates + (segment.val.predicate - predicates);
+            out.segments[i] = segment;
         }
+        release();
+
+        parsePath(path_str, out);
+        mBlock = block;
+        mSegments = out.segments;
+        mSize = out.segmentCount;
+        mPredicates = out.predicateCount;
+        mChars = out.charCount;
         return true;
     }
 
@@ -68,25 +266,118 @@ namespace JStream {
     /// PathSegment ///
     ///////////////////
 
-    PathSegment::PathSegment(size_t offset) : type(PathSegmentType::OFFSET) {
+    PathSegment::PathSegment(size_t offset) : type(PathSegmentType::OFFSET), len(0) {
         val.offset = offset;
-    } 
+    }
+    PathSegment::PathSegment(PathSegmentType type) : type(type), len(0) {
+        val.offset = 0;
+    }
+    PathSegment::PathSegment(const PathPredicate& predicate) : type(PathSegmentType::PREDICATE), len(0) {
+        val.predicate = &predicate;
+    }
     PathSegment::PathSegment(const char* key) : PathSegment(key, std::strlen(key)) {}
-    PathSegment::PathSegment(const char* key, size_t len) : type(PathSegmentType::KEY) {
-        val.key = (char*) memcpy(new char[len+1], key, len+1);
-    } 
-    PathSegment::PathSegment(String& str) : PathSegment(str.c_str(), str.length()) {}
-    PathSegment::PathSegment(const PathSegment& other) {
-        type = other.type;
-        if(type == PathSegmentType::KEY) {
-            size_t len = std::strlen(other.val.key);
-            val.key = (char*) memcpy(new char[len+1], other.val.key, len+1);
-        } else {
-            val.offset = other.val.offset;
+    PathSegment::PathSegment(const char* key, size_t len) : type(PathSegmentType::KEY), len(len) {
+        val.key = key;
+    }
+    PathSegment::PathSegment(const String& key) : PathSegment(key.c_str(), key.length()) {}
+
+    /////////////////////
+    /// PathPredicate ///
+    /////////////////////
+
+    namespace {
+        /** @brief Applies an operator to the order of a value relative to a literal */
+        bool holds(PredicateOp op, int cmp) {
+            switch(op) {
+                case PredicateOp::EQ: return cmp == 0;
+                case PredicateOp::NE: return cmp != 0;
+                case PredicateOp::LT: return cmp < 0;
+                case PredicateOp::LE: return cmp <= 0;
+                case PredicateOp::GT: return cmp > 0;
+                default: return cmp >= 0;
+            }
         }
     }
-    PathSegment::~PathSegment() {
-        if(type == PathSegmentType::KEY) delete[] val.key;
+
+    bool PathPredicate::matches(JsonParser& value) const {
+        return matches(this, 1, 1, value) != 0;
+    }
+
+    byte PathPredicate::matches(const PathPredicate* predicates, size_t count, byte mask, JsonParser& value) {
+        int c = value.skipWhitespace();
+        Kind valueKind = c == '"' ? STRING : (c == '-' || Internals::isDecDigit(c) ? NUMBER : TOKEN); // Tokens include objects and arrays
+        int cmp[8]; // Order of the value relative to each literal
+        for(size_t i = 0; i < count; i++) cmp[i] = 1;
+
+        switch(valueKind) {
+            case STRING: {
+                // Compare the string with all literals char by char, so it is never stored
+                byte pending = 0; // Literals that equal the string so far
+                for(size_t i = 0; i < count; i++) {
+                    if((mask & (1U << i)) && predicates[i].kind == STRING) pending |= 1U << i;
+                }
+
+                value.read();
+                size_t pos = 0;
+                bool escape = false;
+                while((c = value.read()) >= 0) {
+                    if(escape) {
+                        escape = false;
+                        if(!(c = Internals::escape(c))) { // Any string is bigger than an incorrect one
+                            for(size_t i = 0; i < count; i++) {
+                                if(pending & (1U << i)) cmp[i] = -1;
+                            }
+                            pending = 0;
+                            continue;
+                        }
+                    } else if(c == '\\') {
+                        escape = true;
+                        continue;
+                    } else if(c == '"') break;
+
+                    for(size_t i = 0; i < count; i++) {
+                        if(!(pending & (1U << i))) continue;
+                        unsigned char literal = static_cast<unsigned char>(predicates[i].text.c_str()[pos]);
+                        if(literal != c) {
+                            cmp[i] = literal == '\0' || c > literal ? 1 : -1;
+                            pending &= ~(1U << i);
+                        }
+                    }
+                    pos++;
+                }
+
+                // The string ended (or the json did, then it is incorrect)
+                for(size_t i = 0; i < count; i++) {
+                    if(pending & (1U << i)) cmp[i] = c == '"' && predicates[i].text.c_str()[pos] == '\0' ? 0 : -1;
+                }
+                break;
+            }
+            case NUMBER: {
+                double num = value.parseNum();
+                for(size_t i = 0; i < count; i++) {
+                    if(predicates[i].kind == NUMBER) cmp[i] = num < predicates[i].number ? -1 : (num > predicates[i].number ? 1 : 0);
+                }
+                break;
+            }
+            default: // true, false, null
+                const char* token = nullptr;
+                if(c == 't' || c == 'f') token = value.parseBool() ? "true" : "false";
+                else {
+                    if(c == 'n') token = "null";
+                    value.skipValue();
+                }
+                for(size_t i = 0; i < count; i++) {
+                    if(token && predicates[i].kind == TOKEN && std::strcmp(predicates[i].text.c_str(), token) == 0) cmp[i] = 0;
+                }
+        }
+
+        // Values of another type than the literal's are only unequal to it
+        byte matched = 0;
+        for(size_t i = 0; i < count; i++) {
+            if(!(mask & (1U << i))) continue;
+            if(predicates[i].kind == valueKind ? holds(predicates[i].op, cmp[i]) : predicates[i].op == PredicateOp::NE) matched |= 1U << i;
+        }
+        return matched;
     }
 
 } // JStream
@@ -1,20 +1,86 @@
 #pragma once
 
-#include <vector>
+#include <stddef.h>
 #include <WString.h>
 #include <Internals/Types.h>
 
 namespace JStream
 {
-    class PathSegment; // Forward declaration
+    class JsonParser;
 
-    // Representation of a path that can be used to find Json elements
-    class Path : public std::vector<PathSegment> {
+    enum class PathSegmentType : byte {OFFSET, KEY, ANY_OFFSET, ANY_KEY, DESCENDANT, PREDICATE};
+    enum class PredicateOp : byte {EQ, NE, LT, LE, GT, GE};
+
+    /**
+     * @brief Comparison of a member of json objects with a literal, e.g. "[?type==\"sensor\"]" or "[?temp>=20.5]"
+     * 
+     * Operators: "==", "!=", "<", "<=", ">", ">="
+     * Literals: strings in '"' or '\'' (compared char by char), numbers, true, false and null (only "==" and "!=")
+     * Values of another type than the literal's are only unequal to it.
+     */
+    struct PathPredicate {
+        enum Kind : byte {STRING, NUMBER, TOKEN};
+
+        String key; // Compared member
+        PredicateOp op;
+        Kind kind;
+        String text; // Unescaped string or token (true, false, null)
+        double number;
+
+        /** @brief Tests the next value of a parser, the value is consumed */
+        bool matches(JsonParser& value) const;
+        /**
+         * @brief Tests the next value of a parser against several predicates at once, while reading it (nothing is buffered)
+         * @param count Number of predicates, at most 8
+         * @param mask Mask of the tested predicates
+         * @return Mask of the matched predicates
+         */
+        static byte matches(const PathPredicate* predicates, size_t count, byte mask, JsonParser& value);
+    };
+
+    /** @brief Segment of a path, it refers to its key or predicate without owning it */
+    struct PathSegment {
+        PathSegment(size_t offset);
+        PathSegment(PathSegmentType type);
+        PathSegment(const PathPredicate& predicate);
+        PathSegment(const char* key); // Refers to the key, which has to outlive the segment (it isn't copied)
+        PathSegment(const char* key, size_t len); // Refers to the key, which has to outlive the segment (it isn't copied)
+        PathSegment(const String& key); // Refers to the chars of the String, which has to outlive the segment
+        PathSegment(String&& key) = delete; // A temporary String would leave the segment dangling
+
+        PathSegmentType type;
+        union {
+            size_t offset;
+            const char* key; // Null-terminated
+            const PathPredicate* predicate;
+        } val;
+        size_t len; // Length of the key
+    };
+
+    /** @brief Segment of a StaticPath (see StaticPath.h) */
+    struct StaticSegment {
+        PathSegmentType type;
+        size_t val; // Offset of OFFSET segments, position of the key in the path's key chars for KEY segments
+    };
+
+    /**
+     * @brief Representation of a path that can be used to find Json elements
+     * 
+     * The segments, their keys and predicates are stored in one memory block, which is allocated once per appended string.
+     * Paths can be moved, but not copied.
+     */
+    class Path {
         public:
             bool isValid;
 
             Path(const char* path_str);
+            /** @param n Number of segments, only a hint (kept for compatibility, the block is always sized to fit) */
             Path(const char* path_str, size_t n);
+            Path(Path&& other) noexcept;
+            Path& operator=(Path&& other) noexcept;
+            Path(const Path&) = delete;
+            Path& operator=(const Path&) = delete;
+            ~Path();
 
             /**
              * @brief Appends a path to the end of the path
@@ -22,25 +88,31 @@ namespace JStream
              * Formatting:
              *  - "[n]": OFFSET segment, n-th child element in the parent json array/object
              *  - "akey": KEY segment, child "akey" of the parent json object
+             *  - "[*]": ANY_OFFSET segment, every child element in the parent json array/object
+             *  - "*": ANY_KEY segment, every child of the parent json object (a key "*" has to be escaped as "\*")
+             *  - "..akey": DESCENDANT segment followed by a KEY segment, "akey" at any depth below the parent (".." in keys has to be escaped as "\..")
+             *  - "**": DESCENDANT segment, any depth below the parent (i.e. ".." followed by a key is short for "**" followed by the key)
+             *  - "[?akey==\"val\"]": PREDICATE segment, every child element whose member "akey" compares to the literal (see PathPredicate)
              *  - "key1/key2[2]/key3": KEY segments are seperated from previous segments with a '/'
              *  - "akey[2][2]": OFFSET segments can be appended directly to other segments
+             * 
+             * @return false if the path is invalid, nothing is appended then
              */
             bool append(const char* path_str);
-    };
 
-    enum class PathSegmentType : byte {OFFSET, KEY};
-    struct PathSegment {
-        PathSegment(size_t offset);
-        PathSegment(const char* key);
-        PathSegment(const char* key, size_t len);
-        PathSegment(String& key);
-        PathSegment(const PathSegment& other);
-        ~PathSegment();
+            size_t size() const { return mSize; }
+            bool empty() const { return mSize == 0; }
+            const PathSegment& at(size_t i) const { return mSegments[i]; }
+            const PathSegment& operator[](size_t i) const { return mSegments[i]; }
+            const PathSegment* begin() const { return mSegments; }
+            const PathSegment* end() const { return mSegments + mSize; }
+        private:
+            char* mBlock = nullptr; // Predicates, segments and null-terminated keys
+            PathSegment* mSegments = nullptr;
+            size_t mSize = 0;
+            size_t mPredicates = 0; // Number of predicates at the start of the block
+            size_t mChars = 0; // Number of key chars at the end of the block
 
-        PathSegmentType type;
-        union {
-            size_t offset;
-            const char* key;
-        } val;
+            void release();
     };
 } // Jstream
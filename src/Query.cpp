@@ -0,0 +1,198 @@
+#include "Query.h"
+#include <cstring>
+#include <algorithm>
+
+namespace JStream {
+
+    namespace {
+        /** @brief Node of the trie, in which the shared prefixes of the paths are merged */
+        struct PathNode {
+            std::vector<std::pair<const PathSegment*, size_t>> edges; // Segment leading to a child node
+            std::vector<size_t> paths; // Paths ending in the node
+            bool anyDepth = false; // The node is reached by a descendant segment, each member of its values reaches it again
+            const PathPredicate* predicate = nullptr; // The node is reached by a predicate segment, its edges only lead anywhere if it matched
+        };
+
+        bool sameSegment(const PathSegment& a, const PathSegment& b) {
+            if(a.type != b.type) return false;
+            if(a.type == PathSegmentType::KEY) return a.len == b.len && std::memcmp(a.val.key, b.val.key, a.len) == 0;
+            if(a.type == PathSegmentType::OFFSET) return a.val.offset == b.val.offset;
+            if(a.type == PathSegmentType::PREDICATE) {
+                const PathPredicate& p = *a.val.predicate;
+                const PathPredicate& q = *b.val.predicate;
+                return p.key == q.key && p.op == q.op && p.kind == q.kind && p.text == q.text && p.number == q.number;
+            }
+            return true;
+        }
+
+        /** @brief Adds the nodes reached by descendant segments, which also match zero levels, to a sorted set of nodes */
+        void closure(const std::vector<PathNode>& nodes, std::vector<size_t>& set) {
+            for(size_t i = 0; i < set.size(); i++) {
+                for(auto& edge : nodes[set[i]].edges) {
+                    if(edge.first->type == PathSegmentType::DESCENDANT && std::find(set.begin(), set.end(), edge.second) == set.end()) {
+                        set.push_back(edge.second);
+                    }
+                }
+            }
+            std::sort(set.begin(), set.end());
+        }
+
+        /** @brief Inserts a value into a sorted vector, unless it already contains it */
+        void insertSorted(std::vector<size_t>& vec, size_t val) {
+            auto it = std::lower_bound(vec.begin(), vec.end(), val);
+            if(it == vec.end() || *it != val) vec.insert(it, val);
+        }
+    }
+
+    Query::Query(std::initializer_list<const char*> paths) {
+        std::vector<Path> compiled;
+        compiled.reserve(paths.size());
+        for(const char* path : paths) compiled.emplace_back(path);
+        compile(compiled.data(), compiled.size());
+    }
+
+    Query::Query(const Path* paths, size_t count) {
+        compile(paths, count);
+    }
+
+    void Query::compile(const Path* paths, size_t count) {
+        isValid = true;
+        mPathCount = count;
+
+        // Merge the shared prefixes of the paths
+        std::vector<PathNode> nodes(1);
+        bool descendants = false;
+        maxDepth = 0;
+        for(size_t path = 0; path < count; path++) {
+            if(!paths[path].isValid) isValid = false;
+
+            size_t node = 0;
+            for(const PathSegment& segment : paths[path]) {
+                size_t child = 0;
+                for(auto& edge : nodes[node].edges) {
+                    if(sameSegment(*edge.first, segment)) child = edge.second;
+                }
+                if(child == 0) { // The root is never a child
+                    nodes.emplace_back();
+                    child = nodes.size() - 1;
+                    nodes[node].edges.push_back({&segment, child});
+                }
+                if(segment.type == PathSegmentType::DESCENDANT) {
+                    nodes[child].anyDepth = true;
+                    descendants = true;
+                }
+                if(segment.type == PathSegmentType::PREDICATE) nodes[child].predicate = segment.val.predicate;
+                node = child;
+            }
+            if(nodes[node].predicate != nullptr) isValid = false; // A matched object is only known after walking it
+            nodes[node].paths.push_back(path);
+            maxDepth = std::max(maxDepth, paths[path].size());
+        }
+
+        if(descendants) maxDepth = DEFAULT_MAX_DEPTH;
+
+        // Each state of the automaton is a set of trie nodes, that are reached by the same json values
+        std::vector<std::vector<size_t>> stateNodes = {{0}};
+        closure(nodes, stateNodes[0]);
+        for(size_t state = 0; state < stateNodes.size(); state++) {
+            std::vector<size_t> current = stateNodes[state]; // Copy, new states might be added
+
+            // Keys and offsets leading out of the state
+            std::vector<const char*> keyLabels;
+            std::vector<size_t> offsetLabels;
+            std::vector<size_t> guarded; // Nodes reached by predicates
+            auto addKey = [&](const char* key) {
+                for(const char* label : keyLabels) {
+                    if(std::strcmp(label, key) == 0) return;
+                }
+                keyLabels.push_back(key);
+            };
+            for(size_t node : current) {
+                if(nodes[node].predicate != nullptr) {
+                    guarded.push_back(node);
+                    addKey(nodes[node].predicate->key.c_str());
+                }
+                for(auto& edge : nodes[node].edges) {
+                    const PathSegment& segment = *edge.first;
+                    if(segment.type == PathSegmentType::KEY) {
+                        addKey(segment.val.key);
+                    } else if(segment.type == PathSegmentType::OFFSET
+                        && std::find(offsetLabels.begin(), offsetLabels.end(), segment.val.offset) == offsetLabels.end()) {
+                        offsetLabels.push_back(segment.val.offset);
+                    }
+                }
+            }
+
+            std::sort(offsetLabels.begin(), offsetLabels.end());
+            if(guarded.size() > MAX_PREDICATES) {
+                isValid = false;
+                guarded.resize(MAX_PREDICATES);
+            }
+
+            State compiled(keyLabels);
+            compiled.offsets = offsetLabels;
+            for(size_t node : current) {
+                for(size_t path : nodes[node].paths) insertSorted(compiled.paths, path);
+            }
+            for(size_t node : guarded) {
+                compiled.predicates.push_back(*nodes[node].predicate);
+                compiled.predicateKeys.push_back(compiled.keys.indexOf(nodes[node].predicate->key.c_str()));
+            }
+
+            // Target for each combination of the matched predicates, a member's key and index, the index might not be at any offset (0)
+            for(size_t matched = 0; matched <= compiled.allPredicates(); matched++) {
+                for(int key = NO_KEY; key < static_cast<int>(keyLabels.size()); key++) {
+                    for(size_t offset = 0; offset <= offsetLabels.size(); offset++) {
+                        std::vector<size_t> targetNodes;
+                        for(size_t node : current) {
+                            auto guard = std::find(guarded.begin(), guarded.end(), node);
+                            if(guard != guarded.end() && !(matched & (1U << (guard - guarded.begin())))) continue;
+
+                            for(auto& edge : nodes[node].edges) {
+                                const PathSegment& segment = *edge.first;
+                                bool matches = false;
+                                switch(segment.type) {
+                                    case PathSegmentType::KEY:
+                                        matches = key >= 0 && std::strcmp(segment.val.key, keyLabels[key]) == 0;
+                                        break;
+                                    case PathSegmentType::OFFSET:
+                                        matches = offset > 0 && segment.val.offset == offsetLabels[offset - 1];
+                                        break;
+                                    case PathSegmentType::ANY_OFFSET: case PathSegmentType::PREDICATE: // Predicates are evaluated on the member
+                                        matches = true;
+                                        break;
+                                    case PathSegmentType::ANY_KEY:
+                                        matches = key != NO_KEY;
+                                        break;
+                                    case PathSegmentType::DESCENDANT: // Matches zero levels, see closure()
+                                        break;
+                                }
+                                if(matches) insertSorted(targetNodes, edge.second);
+                            }
+                            if(nodes[node].anyDepth) insertSorted(targetNodes, node);
+                        }
+                        closure(nodes, targetNodes);
+
+                        size_t target = NO_STATE;
+                        if(!targetNodes.empty()) {
+                            target = std::find(stateNodes.begin(), stateNodes.end(), targetNodes) - stateNodes.begin();
+                            if(target == stateNodes.size()) stateNodes.push_back(targetNodes);
+                            compiled.descend = true;
+                        }
+                        compiled.targets.push_back(target);
+                    }
+                }
+            }
+
+            mStates.push_back(compiled);
+
+            // Each key leads to one value, once all of them were visited the rest of the object can be skipped
+            if(offsetLabels.empty() && !keyLabels.empty() && keyLabels.size() <= sizeof(unsigned long)*8
+                && unlisted(state, NO_KEY) == NO_STATE && unlisted(state, KEY_UNKNOWN) == NO_STATE) {
+                mStates[state].allKeys = ~0UL >> (sizeof(unsigned long)*8 - keyLabels.size());
+            }
+        }
+
+        mFrames.reserve(maxDepth + 1);
+    }
+}
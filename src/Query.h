@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <initializer_list>
+#include <stddef.h>
+#include <Path.h>
+#include <KeySet.h>
+
+namespace JStream
+{
+    /**
+     * @brief Set of paths that are searched in a single pass over the json (see JsonParser::query())
+     *
+     * The paths are compiled into one automaton when constructing the query: Shared prefixes of the paths are merged,
+     * so each json value is only looked at once, regardless of how many paths lead through it.
+     * Every state of the automaton matches the keys of an object with a KeySet.
+     * The index of a path is its position in the list the query was constructed from.
+     *
+     * Predicate segments (see PathPredicate) are evaluated, when the walker reaches the compared member of an object.
+     * Members following it are walked right away, preceding members that only lead to paths through the predicate are
+     * buffered (up to bufferSize chars) and walked once the predicate matched.
+     */
+    class Query {
+        public:
+            bool isValid;
+            /**
+             * @brief Maximum number of objects/arrays, that are walked within each other below the walked value
+             * 
+             * Deeper values are skipped. Defaults to the length of the longest path, or DEFAULT_MAX_DEPTH if a path contains a descendant segment.
+             */
+            size_t maxDepth;
+
+            /** @brief Default maxDepth of queries with descendant segments, which match at any depth */
+            static const size_t DEFAULT_MAX_DEPTH = 32;
+
+            /**
+             * @brief Maximum number of chars, that are buffered while the predicates of an object are pending
+             * 
+             * Values that don't fit into the buffer anymore are skipped. Defaults to DEFAULT_BUFFER_SIZE.
+             */
+            size_t bufferSize = DEFAULT_BUFFER_SIZE;
+            static const size_t DEFAULT_BUFFER_SIZE = 64;
+
+            Query(std::initializer_list<const char*> paths);
+            Query(const Path* paths, size_t count);
+
+            /** @brief Number of paths in the query */
+            size_t size() const { return mPathCount; }
+        private:
+            friend class JsonParser;
+
+            /** @brief Automaton state, that is reached by the values of the paths' prefixes */
+            struct State {
+                State(const std::vector<const char*>& keyLabels) : keys(keyLabels.data(), keyLabels.size()) {}
+
+                KeySet keys; // Keys leading to other states or compared by predicates
+                std::vector<size_t> offsets; // Offsets leading to other states, sorted
+                std::vector<size_t> targets; // Next state for each set of matched predicates, key (see target()) and offset (or none)
+                std::vector<size_t> paths; // Paths ending in the state
+                std::vector<PathPredicate> predicates; // Predicates on the members of the state's objects
+                std::vector<int> predicateKeys; // Key compared by each predicate
+                bool descend = false; // At least one target isn't NO_STATE
+                unsigned long allKeys = 0; // Mask of all keys, if only keys lead to other states (objects are exited once each key was visited)
+
+                /** @brief Mask of all predicates */
+                byte allPredicates() const { return static_cast<byte>((1U << predicates.size()) - 1); }
+            };
+
+            /** @brief Object/array that is walked by JsonParser::query() */
+            struct Frame {
+                size_t state;
+                size_t index; // Index of the current member
+                bool object;
+                unsigned long seen; // Mask of the visited keys
+                byte known; // Mask of the evaluated predicates
+                byte matched; // Mask of the matched predicates
+                size_t candidates; // First buffered candidate of the object/array
+            };
+
+            /** @brief Member that is buffered until the predicates deciding about it were evaluated */
+            struct Candidate {
+                int key;
+                size_t index;
+                size_t start; // Position in the buffer
+                size_t length;
+            };
+
+            /** @brief Target of members that don't lead to any path */
+            static const size_t NO_STATE = static_cast<size_t>(-1);
+            /** @brief Key of array elements (see target()) */
+            static const int NO_KEY = -2;
+            /** @brief Key that isn't in a state's key set (see target()) */
+            static const int KEY_UNKNOWN = -1;
+            /** @brief Maximum number of predicates on the members of the same object */
+            static const size_t MAX_PREDICATES = 4;
+
+            std::vector<State> mStates; // The first state is reached by the queried value itself
+            std::vector<Frame> mFrames; // Objects/arrays that are walked
+            std::vector<Candidate> mCandidates; // Buffered members of the walked objects/arrays
+            size_t mPathCount = 0;
+
+            /**
+             * @brief Returns the state reached by a member of an object/array
+             * @param key Index of the member's key in the state's key set, KEY_UNKNOWN if it isn't in the set, or NO_KEY
+             * @param index Index of the member in its object/array
+             * @param matched Mask of the matched predicates
+             */
+            size_t target(size_t state, int key, size_t index, byte matched=0) const {
+                const State& s = mStates[state];
+                size_t offset = 0;
+                while(offset < s.offsets.size() && s.offsets[offset] != index) offset++;
+                if(offset == s.offsets.size()) offset = 0;
+                else offset++;
+
+                return s.targets[(matched * (s.keys.size() + 2) + static_cast<size_t>(key - NO_KEY)) * (s.offsets.size() + 1) + offset];
+            }
+            /** @brief Returns the state reached by members that aren't at any of the state's offsets, if all predicates matched */
+            size_t unlisted(size_t state, int key) const {
+                const State& s = mStates[state];
+                return s.targets[(s.allPredicates() * (s.keys.size() + 2) + static_cast<size_t>(key - NO_KEY)) * (s.offsets.size() + 1)];
+            }
+
+            void compile(const Path* paths, size_t count);
+    };
+} // JStream
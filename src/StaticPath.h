@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stddef.h>
+#include <Path.h>
+#include <Internals/JsonUtils.h>
+
+namespace JStream
+{
+    namespace Internals {
+        /** @brief Result of parsePath() for invalid paths */
+        constexpr size_t INVALID_PATH = static_cast<size_t>(-1);
+
+        /**
+         * @brief Parses a path with the formatting of Path::append() at compile time
+         *
+         * Descendant and predicate segments can't be found without a Query and are invalid.
+         * @param segments Receives the segments, nullptr to only count them
+         * @param keys Receives the unescaped, null-terminated keys, nullptr to only count the segments
+         * @return The number of segments, or INVALID_PATH
+         */
+        constexpr size_t parsePath(const char* str, StaticSegment* segments, char* keys) {
+            size_t count = 0;
+            size_t keyPos = 0;
+            while(*str) {
+                if(str[0] == '.' && str[1] == '.') return INVALID_PATH; // descendant
+
+                if(*str == '[') { // array path segment
+                    str++;
+
+                    StaticSegment segment = {PathSegmentType::ANY_OFFSET, 0};
+                    if(str[0] == '*' && str[1] == ']') { // wildcard, any element
+                        str += 2;
+                    } else {
+                        // Read offset
+                        segment.type = PathSegmentType::OFFSET;
+                        while(*str != ']') {
+                            if(!isDecDigit(*str)) return INVALID_PATH; // Not an offset, or not closed
+                            segment.val = segment.val*10 + *str++ - '0';
+                        }
+                        str++;
+                    }
+                    if(segments) segments[count] = segment;
+                    count++;
+
+                    // offset (i.e. '[...]') can only be followed by another offset or the start of a key (i.e. '/')
+                    if(*str && *str != '/' && *str != '[') return INVALID_PATH;
+                } else { // key path segment
+                    if(*str == '/') str++;
+
+                    // wildcard, any key ('**' would be a descendant)
+                    if(str[0] == '*' && (!str[1] || str[1] == '/' || str[1] == '[' || str[1] == '*')) {
+                        if(str[1] == '*') return INVALID_PATH;
+                        str++;
+                        if(segments) segments[count] = {PathSegmentType::ANY_KEY, 0};
+                        count++;
+                        continue;
+                    }
+
+                    // Read key
+                    if(segments) segments[count] = {PathSegmentType::KEY, keyPos};
+                    count++;
+                    while(*str && *str != '[') {
+                        char c = *str++;
+                        if(c == '/') break;
+                        if(c == '.' && *str == '.') return INVALID_PATH; // descendant
+                        if(c == '\\') {
+                            if(!*str) return INVALID_PATH;
+                            if(*str != '[' && *str != '/' && *str != '*' && *str != '.') {
+                                if(keys) keys[keyPos] = c;
+                                keyPos++;
+                            }
+                            c = *str++;
+                        }
+                        if(keys) keys[keyPos] = c;
+                        keyPos++;
+                    }
+                    if(keys) keys[keyPos] = '\0';
+                    keyPos++;
+                }
+            }
+            return count;
+        }
+
+        /** @brief Called for invalid path literals, it isn't constexpr so they fail to compile */
+        inline size_t invalidPathLiteral() {
+            return 0;
+        }
+
+        /** @brief Returns the number of segments of a path literal (see JSTREAM_PATH) */
+        constexpr size_t countSegments(const char* path) {
+            return parsePath(path, nullptr, nullptr) != INVALID_PATH ? parsePath(path, nullptr, nullptr) : invalidPathLiteral();
+        }
+    }
+
+    /**
+     * @brief Path that is parsed at compile time into a segment table, it is found without parsing or allocating (see JsonParser::find())
+     *
+     * Needs C++14 (relaxed constexpr), the rest of the library only needs C++11.
+     * Use JSTREAM_PATH() to construct it from a string literal with the formatting of Path::append(), e.g.:
+     * static constexpr auto path = JSTREAM_PATH("weather[0]/main");
+     * The keys are unescaped and stored in the path itself, so the path doesn't need any memory besides its own.
+     * Descendant and predicate segments aren't supported, paths containing them don't compile.
+     */
+    template<size_t SEGMENTS, size_t CHARS>
+    class StaticPath {
+        public:
+            bool isValid = false;
+            StaticSegment segments[SEGMENTS > 0 ? SEGMENTS : 1] = {};
+            char keys[CHARS] = {}; // Unescaped, null-terminated keys
+
+            constexpr StaticPath(const char (&path)[CHARS]) {
+                isValid = Internals::parsePath(path, segments, keys) == SEGMENTS;
+            }
+
+            /** @brief Number of segments */
+            constexpr size_t size() const { return SEGMENTS; }
+    };
+} // JStream
+
+/** @brief Parses a path literal at compile time into a StaticPath */
+#define JSTREAM_PATH(path) JStream::StaticPath<JStream::Internals::countSegments(path), sizeof(path)>(path)
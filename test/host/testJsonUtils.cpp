@@ -13,11 +13,31 @@
 #define protected public
 #define private   public
 #include <Internals/JsonUtils.h>
+#include <Internals/Scan.h>
 #undef protected
 #undef private
 
 using namespace JStream;
 
+/** @brief Returns all digits of m * 2^exp2 (exp2 <= 0) */
+static std::string exactDecimal(uint64_t m, int exp2) {
+    // m * 5^-exp2 * 10^exp2, the digits are multiplied in a string
+    std::string digits = std::to_string(m);
+    for(int i = 0; i < -exp2; i++) {
+        int carry = 0;
+        for(size_t j = digits.size(); j-- > 0;) {
+            int product = (digits[j] - '0')*5 + carry;
+            digits[j] = static_cast<char>('0' + product % 10);
+            carry = product / 10;
+        }
+        if(carry) digits.insert(digits.begin(), static_cast<char>('0' + carry));
+    }
+
+    long point = static_cast<long>(digits.size()) + exp2;
+    if(point <= 0) return "0." + std::string(-point, '0') + digits;
+    return digits.substr(0, point) + "." + digits.substr(point);
+}
+
 TEST_CASE("::stol") {
     JsonParser parser();
 
@@ -140,4 +160,262 @@ TEST_CASE("::stod") {
             REQUIRE(std::fabs(expectedVal-result) <= 0.000000000001);
         }
     }
-}
\ No newline at end of file
+
+    SECTION("correctly rounded") {
+        auto requireSameAsStrtod = [](const char* str) {
+            CAPTURE(str);
+            double result = Internals::stod(str);
+            double expected = std::strtod(str, nullptr);
+            REQUIRE(std::memcmp(&result, &expected, sizeof(double)) == 0);
+        };
+
+        const char* exact[] = {
+            "0.1", "1e-300", "1e300", "1e23", "8.98846567431158e307", "123456789012345678901234567890",
+            "9007199254740993", // Halfway between 2^53 and 2^53 + 2, rounds to even
+            "9007199254740993.0000000000000000001", "9007199254740995", "-9007199254740993",
+            "2.2250738585072011e-308", "2.2250738585072014e-308", // Largest subnormal, smallest normal
+            "4.9406564584124654e-324", "2.4703282292062327e-324", "2.4703282292062328e-324", "1e-400",
+            "1.7976931348623157e308", "1.7976931348623158e308", "1.797693134862315807937289714053e308", "1e400",
+            "7.4109846876186982e-323", "0.000000000000000000000000000000000000000000001",
+            "1.00000000000000011102230246251565404", "1.00000000000000011102230246251565405",
+            "0.50000000000000005551115123125782702118", "6.6564021122018745e+52", "12345678901234567890e-30",
+        };
+        for(const char* str : exact) requireSameAsStrtod(str);
+
+        // Random doubles and their halfway points, printed with up to 38 digits
+        unsigned int seed = 42;
+        auto next = [&seed]() { return (seed = seed*1103515245 + 12345) >> 16; };
+        char str[64];
+        for(int test = 0; test < 20000; test++) {
+            uint64_t bits = static_cast<uint64_t>(next()) << 48 ^ static_cast<uint64_t>(next()) << 32 ^ next() << 16 ^ next();
+            bits &= 0x7FEFFFFFFFFFFFFFULL;
+            double d;
+            std::memcpy(&d, &bits, sizeof(double));
+
+            snprintf(str, sizeof(str), "%.17g", d);
+            requireSameAsStrtod(str);
+            snprintf(str, sizeof(str), "%.*g", static_cast<int>(next() % 17 + 1), d);
+            requireSameAsStrtod(str);
+            snprintf(str, sizeof(str), "%.*Le", static_cast<int>(next() % 24 + 14), (static_cast<long double>(d) + std::nextafter(d, INFINITY)) / 2);
+            requireSameAsStrtod(str);
+        }
+
+        // Halfway points need up to 767 digits, numbers just above or below them only differ after the 38th digit
+        requireSameAsStrtod("1.000000000000000111022302462515654042363166809082031250000001");
+        requireSameAsStrtod("1.000000000000000111022302462515654042363166809082031249999999");
+        for(int test = 0; test < 200; test++) {
+            uint64_t m = (static_cast<uint64_t>(next()) << 32 ^ static_cast<uint64_t>(next()) << 16 ^ next()) | 1; // Odd, so the last digit isn't 0
+            int exp2 = test == 0 ? -1075 : -1 - static_cast<int>(next() % 1100);
+            if(test == 0) m = 1; // Half of the smallest subnormal
+            std::string halfway = exactDecimal(m, exp2);
+            requireSameAsStrtod(halfway.c_str());
+            requireSameAsStrtod((halfway + "0000000000000000000000001").c_str());
+
+            std::string above = halfway, below = halfway;
+            above.back()++;
+            below.back()--;
+            requireSameAsStrtod(above.c_str());
+            requireSameAsStrtod((below + "99999999999999999999").c_str());
+            requireSameAsStrtod((halfway + std::string(1000, '0') + "1e-3").c_str()); // Digits after the 768th only tell that it's above
+        }
+    }
+}
+TEST_CASE("::findQuoteOrEscape") {
+    // Cover each position within and after the vectorized blocks
+    for(size_t len = 0; len <= 100; len++) {
+        for(size_t pos = 0; pos <= len; pos++) {
+            for(char c : {'"', '\\'}) {
+                std::string str(len, 'a');
+                if(pos < len) str[pos] = c;
+                if(pos + 1 < len) str[pos + 1] = c == '"' ? '\\' : '"'; // Only the first match counts
+
+                CAPTURE(len, pos, c);
+
+                const char* found = Internals::findQuoteOrEscape(str.data(), str.data() + len);
+                REQUIRE(found == str.data() + pos);
+            }
+        }
+    }
+
+    SECTION("unaligned ranges") {
+        std::string str = "0123456789abcdefghijklmnopqrstuvwxyz\\0123456789";
+        for(size_t start = 0; start < 8; start++) {
+            CAPTURE(start);
+            REQUIRE(Internals::findQuoteOrEscape(str.data() + start, str.data() + str.size()) == str.data() + 36);
+            REQUIRE(Internals::findQuoteOrEscape(str.data() + start, str.data() + 36 - start) == str.data() + 36 - start);
+        }
+    }
+
+    SECTION("non-ascii chars") {
+        std::string str = "\xff\x80\xa2\xdc\x22\x5c";
+        str = str + str + str + str + str + str;
+        REQUIRE(Internals::findQuoteOrEscape(str.data(), str.data() + str.size()) == str.data() + 4);
+    }
+}
+
+TEST_CASE("::findNonWhitespace") {
+    const char* whitespace = " \t\n\r";
+
+    for(size_t start = 0; start < 8; start++) {
+        for(size_t len = 0; len <= 40; len++) {
+            std::string str(start, 'x');
+            for(size_t i = 0; i < len; i++) str += whitespace[(i*7 + len) % 4];
+            str += "\x20\x21\x09\x0a" + std::string(start, ' '); // Whitespace after the first non-whitespace char doesn't count
+
+            CAPTURE(start, len);
+
+            const char* found = Internals::findNonWhitespace(str.data() + start, str.data() + str.size());
+            REQUIRE(found == str.data() + start + len + 1);
+            REQUIRE(Internals::findNonWhitespace(str.data() + start, str.data() + start + len) == str.data() + start + len);
+        }
+    }
+}
+
+/** @brief Reference for skipNested, looks at every char */
+static const char* skipNestedReference(const char* it, const char* end, size_t& depth, bool& inStr, bool& escape) {
+    for(; it != end && (inStr || depth > 0); it++) {
+        if(inStr) {
+            if(escape) escape = false;
+            else if(*it == '\\') escape = true;
+            else if(*it == '"') inStr = false;
+        } else if(*it == '{' || *it == '[') depth++;
+        else if(*it == '}' || *it == ']') depth--;
+        else if(*it == '"') {
+            inStr = true;
+            escape = false;
+        }
+    }
+    return it;
+}
+
+/** @brief Appends the content of a random string (without quotes) that may contain escapes and brackets */
+static void appendRandomStringContent(std::string& str, unsigned int& seed) {
+    const char* chars[] = {"a", " ", "{", "]", "\\\\", "\\\"", "\\n", "\\\\\\\""};
+    size_t len = (seed = seed*1103515245 + 12345) >> 16 & 15;
+    for(size_t i = 0; i < len; i++) str += chars[((seed = seed*1103515245 + 12345) >> 16) % 8];
+}
+
+TEST_CASE("::skipNested") {
+    const char* tokens[] = {"{", "}", "[", "]", "{", "}", "[", "]", ",", " ", "a", "1.5", "\"\"", "STRING"};
+    unsigned int seed = 42;
+
+    for(int test = 0; test < 2000; test++) {
+        size_t depth = (seed = seed*1103515245 + 12345) >> 16 & 3;
+        bool inStr = ((seed = seed*1103515245 + 12345) >> 16 & 1) || depth == 0;
+        bool escape = inStr && ((seed = seed*1103515245 + 12345) >> 16 & 1);
+
+        // Random json, which starts in a string and/or escaped char if required
+        std::string str;
+        if(escape) str += '"';
+        if(inStr) {
+            appendRandomStringContent(str, seed);
+            str += '"';
+        }
+        size_t tokenCount = (seed = seed*1103515245 + 12345) >> 16 & 255;
+        for(size_t i = 0; i < tokenCount; i++) {
+            const char* token = tokens[((seed = seed*1103515245 + 12345) >> 16) % 14];
+            if(std::strcmp(token, "STRING") == 0) {
+                str += '"';
+                appendRandomStringContent(str, seed);
+                str += '"';
+            } else str += token;
+        }
+        size_t len = str.size();
+
+        // Skip in one range and in two ranges
+        size_t split = len == 0 ? 0 : ((seed = seed*1103515245 + 12345) >> 16) % len;
+        CAPTURE(str, depth, inStr, escape, split);
+
+        size_t expectedDepth = depth;
+        bool expectedInStr = inStr, expectedEscape = escape;
+        const char* expected = skipNestedReference(str.data(), str.data() + len, expectedDepth, expectedInStr, expectedEscape);
+
+        size_t resultDepth = depth;
+        bool resultInStr = inStr, resultEscape = escape;
+        const char* result = Internals::skipNested(str.data(), str.data() + len, resultDepth, resultInStr, resultEscape);
+        REQUIRE(result == expected);
+        REQUIRE(resultDepth == expectedDepth);
+        REQUIRE(resultInStr == expectedInStr);
+        REQUIRE(resultEscape == expectedEscape);
+
+        resultDepth = depth;
+        resultInStr = inStr;
+        resultEscape = escape;
+        result = Internals::skipNested(str.data(), str.data() + split, resultDepth, resultInStr, resultEscape);
+        if(result == str.data() + split) result = Internals::skipNested(result, str.data() + len, resultDepth, resultInStr, resultEscape);
+        REQUIRE(result == expected);
+        REQUIRE(resultDepth == expectedDepth);
+        REQUIRE(resultInStr == expectedInStr);
+        REQUIRE(resultEscape == expectedEscape);
+    }
+}
+
+/** @brief Reference for decodeBase64, encodes bytes with the standard alphabet */
+static std::string encodeBase64(const std::vector<byte>& bytes) {
+    const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string str;
+    for(size_t i = 0; i + 2 < bytes.size(); i += 3) {
+        unsigned long group = bytes[i] << 16 | bytes[i+1] << 8 | bytes[i+2];
+        for(int shift = 18; shift >= 0; shift -= 6) str += alphabet[group >> shift & 63];
+    }
+    return str;
+}
+
+TEST_CASE("::decodeBase64 & ::decodeHex") {
+    unsigned int seed = 7;
+    std::vector<byte> bytes(300);
+    for(byte& b : bytes) b = static_cast<byte>((seed = seed*1103515245 + 12345) >> 16);
+    std::string encoded = encodeBase64(bytes);
+
+    SECTION("whole groups") {
+        // Cover each length within and after the vectorized blocks, with more or less room than needed
+        for(size_t groups = 0; groups <= 100; groups++) {
+            for(size_t room : {groups*3, groups*3 + 31, groups*3 - (groups > 0)}) {
+                CAPTURE(groups, room);
+
+                std::vector<byte> out(room + 32, 0);
+                const char* it = encoded.data();
+                size_t decoded = Internals::decodeBase64(it, encoded.data() + groups*4, out.data(), room);
+
+                size_t expected = std::min(groups, room / 3);
+                REQUIRE(decoded == expected*3);
+                REQUIRE(it == encoded.data() + expected*4);
+                REQUIRE(std::equal(out.begin(), out.begin() + decoded, bytes.begin()));
+                REQUIRE(out[room] == 0); // Nothing is written past the room
+            }
+        }
+    }
+
+    SECTION("invalid chars") {
+        // Decoding stops before the group containing the char
+        for(size_t pos = 0; pos < 128; pos++) {
+            for(char c : {'=', '"', '\\', '.', '\x80'}) {
+                std::string str = encoded.substr(0, 128);
+                str[pos] = c;
+                CAPTURE(pos, c);
+
+                std::vector<byte> out(128);
+                const char* it = str.data();
+                REQUIRE(Internals::decodeBase64(it, str.data() + str.size(), out.data(), out.size()) == pos / 4 * 3);
+                REQUIRE(it == str.data() + pos / 4 * 4);
+            }
+        }
+    }
+
+    SECTION("url-safe alphabet") {
+        std::string str = "-_-_";
+        byte out[3];
+        const char* it = str.data();
+        REQUIRE(Internals::decodeBase64(it, str.data() + str.size(), out, sizeof(out)) == 3);
+        REQUIRE((out[0] == 0xfb && out[1] == 0xff && out[2] == 0xbf));
+    }
+
+    SECTION("hex") {
+        std::string str = "00fFa5C3x1";
+        byte out[8];
+        const char* it = str.data();
+        REQUIRE(Internals::decodeHex(it, str.data() + str.size(), out, sizeof(out)) == 4);
+        REQUIRE((out[0] == 0x00 && out[1] == 0xff && out[2] == 0xa5 && out[3] == 0xc3));
+        REQUIRE(it == str.data() + 8);
+    }
+}
@@ -14,6 +14,7 @@
 #define protected public
 #define private   public
 #include <JsonParser.h>
+#include <StaticPath.h>
 #undef protected
 #undef private
 
@@ -125,6 +126,29 @@ TEST_CASE("JsonParser::readString & JsonParser::skipString", "[readString, skipS
             CHECK_THAT(str.c_str(), Catch::Matchers::Equals(expected_str));
             CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
 
+            // readString into a fixed buffer
+            stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            char buf[64];
+            size_t length = 0;
+            REQUIRE(parser.readString(buf, sizeof(buf), &length, inStr));
+            CHECK_THAT(buf, Catch::Matchers::Equals(expected_str));
+            CHECK(length == strlen(expected_str));
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
+
+            // readStringChunks, all chunks but the last one fill the buffer
+            stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            std::vector<std::string> chunks;
+            REQUIRE(parser.readStringChunks(buf, 2, [&](const char* chunk, size_t len) { chunks.push_back(std::string(chunk, len)); }, inStr));
+            std::string joined = "";
+            for(size_t i=0; i<chunks.size(); i++) {
+                if(i+1 < chunks.size()) CHECK(chunks.at(i).size() == 2);
+                joined += chunks.at(i);
+            }
+            CHECK_THAT(joined.c_str(), Catch::Matchers::Equals(expected_str));
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
+
             // skipString
             stream = ArduinoTestUtils::MockStream(json);
             parser.parse(stream);
@@ -133,6 +157,36 @@ TEST_CASE("JsonParser::readString & JsonParser::skipString", "[readString, skipS
         }
     }
 
+    SECTION("truncated strings") {
+        std::vector<std::tuple<const char*, size_t, const char*, size_t>> tests = {
+            {"\"astring\", suffix", 4, "ast", 7},
+            {"\"astring\", suffix", 8, "astring", 7},
+            {"\"astring\", suffix", 1, "", 7},
+            {"\"a\\nstring\\\"\", suffix", 3, "a\n", 9},
+            {"\"äöü\", suffix", 4, "ä\xc3", 6},
+        };
+
+		for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            const size_t size = std::get<1>(tests.at(testIdx));
+            const char* expected_str = std::get<2>(tests.at(testIdx));
+            const size_t expected_length = std::get<3>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            // The rest of the string is skipped
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            char buf[16];
+            size_t length = 0;
+            REQUIRE(parser.readString(buf, size, &length));
+            CHECK_THAT(buf, Catch::Matchers::Equals(expected_str));
+            CHECK(length == expected_length);
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(", suffix"));
+        }
+    }
+
     SECTION("invalid strings") {
         std::vector<std::tuple<const char*, bool, const char*, const char*>> tests = {
             {"", true, "", ""},
@@ -170,6 +224,116 @@ TEST_CASE("JsonParser::readString & JsonParser::skipString", "[readString, skipS
     }
 }
 
+TEST_CASE("JsonParser::readBase64 & JsonParser::readHex", "[readBase64, readHex]") {
+    JsonParser parser;
+
+    SECTION("valid strings") {
+        // Json string | base64 | expected bytes | resulting Json string
+        std::vector<std::tuple<const char*, bool, std::vector<byte>, const char*>> tests = {
+            {"\"\", suffix", true, {}, ", suffix"},
+            {"\"TWFu\", suffix", true, {'M', 'a', 'n'}, ", suffix"},
+            {"\"TWE=\", suffix", true, {'M', 'a'}, ", suffix"},
+            {"\"TQ==\", suffix", true, {'M'}, ", suffix"},
+            {"\"TWE\", suffix", true, {'M', 'a'}, ", suffix"},
+
+            // Escaped chars, whitespace and the url-safe alphabet
+            {"\"\\/+\\/+\", suffix", true, {0xff, 0xef, 0xfe}, ", suffix"},
+            {"\"TW\\nFu\\r\\n\", suffix", true, {'M', 'a', 'n'}, ", suffix"},
+            {"\"_-_-\", suffix", true, {0xff, 0xef, 0xfe}, ", suffix"},
+
+            // Hex
+            {"\"\", suffix", false, {}, ", suffix"},
+            {"\"00fFa5C3\", suffix", false, {0x00, 0xff, 0xa5, 0xc3}, ", suffix"},
+            {"\"de a\\nd\", suffix", false, {0xde, 0xad}, ", suffix"},
+        };
+
+		for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            const bool base64 = std::get<1>(tests.at(testIdx));
+            const std::vector<byte>& expected = std::get<2>(tests.at(testIdx));
+            const char* json_after_exec = std::get<3>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            byte buf[16];
+            size_t length = 0;
+            REQUIRE((base64 ? parser.readBase64(buf, sizeof(buf), &length) : parser.readHex(buf, sizeof(buf), &length)));
+            REQUIRE(length == expected.size());
+            CHECK(std::equal(expected.begin(), expected.end(), buf));
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
+        }
+    }
+
+    SECTION("invalid strings") {
+        std::vector<std::tuple<const char*, bool>> tests = {
+            {"\"T\"", true},
+            {"\"T===\"", true},
+            {"\"TQ==TQ==\"", true},
+            {"\"TW.u\"", true},
+            {"\"TWFu", true},
+            {"12", true},
+            {"\"abc\"", false},
+            {"\"0x12\"", false},
+            {"\"123\"", false},
+        };
+
+		for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            const bool base64 = std::get<1>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            byte buf[16];
+            REQUIRE_FALSE((base64 ? parser.readBase64(buf, sizeof(buf)) : parser.readHex(buf, sizeof(buf))));
+        }
+    }
+
+    SECTION("truncation and chunks") {
+        // 120 bytes, long enough for the vectorized decoding
+        std::string encoded = "";
+        std::vector<byte> bytes;
+        for(int i=0; i<120; i++) bytes.push_back(static_cast<byte>(i * 7));
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for(size_t i=0; i<bytes.size(); i+=3) {
+            unsigned long group = bytes[i] << 16 | bytes[i+1] << 8 | bytes[i+2];
+            for(int shift=18; shift>=0; shift-=6) encoded += alphabet[group >> shift & 63];
+        }
+        std::string json = "\"" + encoded + "\", suffix";
+
+        for(size_t size : {1, 2, 7, 32, 50, 119, 120, 200}) {
+            CAPTURE(size);
+
+            // Truncated into a buffer
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json.c_str());
+            parser.parse(stream);
+            std::vector<byte> buf(size);
+            size_t length = 0;
+            REQUIRE(parser.readBase64(buf.data(), size, &length));
+            REQUIRE(length == bytes.size());
+            CHECK(std::equal(buf.begin(), buf.begin() + std::min(size, bytes.size()), bytes.begin()));
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(", suffix"));
+
+            // In chunks, from memory
+            parser.parse(json.c_str(), json.size());
+            std::vector<byte> decoded;
+            size_t chunks = 0;
+            REQUIRE(parser.readBase64Chunks(buf.data(), size, [&](const byte* chunk, size_t len) {
+                CHECK((len == size || decoded.size() + len == bytes.size()));
+                decoded.insert(decoded.end(), chunk, chunk + len);
+                chunks++;
+            }));
+            CHECK(decoded == bytes);
+            CHECK(chunks == (bytes.size() + size - 1) / size);
+        }
+    }
+}
+
 TEST_CASE("JsonParser::strcmp", "[strcmp]") {
     JsonParser parser;
 
@@ -259,6 +423,74 @@ TEST_CASE("JsonParser::parseInt") {
     }
 }
 
+/** @brief Parses an integer of type T from a stream and from memory, both have to yield the same result */
+template<typename T>
+static void requireInt(const char* json, T expected, bool expectedOverflow, const char* jsonAfterExec) {
+    CAPTURE(json);
+    JsonParser parser;
+
+    ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+    parser.parse(stream);
+    bool overflowed = !expectedOverflow;
+    REQUIRE(parser.parseInt<T>(0, &overflowed) == expected);
+    REQUIRE(overflowed == expectedOverflow);
+    CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(jsonAfterExec));
+
+    parser.parse(json, std::strlen(json));
+    overflowed = !expectedOverflow;
+    REQUIRE(parser.parseInt<T>(0, &overflowed) == expected);
+    REQUIRE(overflowed == expectedOverflow);
+    REQUIRE(parser.skipWhitespace() == (*jsonAfterExec ? static_cast<unsigned char>(*jsonAfterExec) : -1));
+}
+
+TEST_CASE("JsonParser::parseInt<T>") {
+    SECTION("limits of each type") {
+        requireInt<int8_t>("127", 127, false, "");
+        requireInt<int8_t>("-128", -128, false, "");
+        requireInt<int8_t>("128", 127, true, "");
+        requireInt<int8_t>("-129", -128, true, "");
+        requireInt<uint8_t>("255", 255, false, "");
+        requireInt<uint8_t>("256", 255, true, "");
+        requireInt<uint8_t>("-0", 0, false, "");
+        requireInt<uint8_t>("-1", 0, true, "");
+        requireInt<int16_t>("-32768,", -32768, false, ",");
+        requireInt<int16_t>("32768,", 32767, true, ",");
+        requireInt<int32_t>("2147483647", 2147483647, false, "");
+        requireInt<int32_t>("-2147483648", INT32_MIN, false, "");
+        requireInt<int32_t>("2147483648", 2147483647, true, "");
+        requireInt<uint32_t>("4294967295", 4294967295U, false, "");
+        requireInt<uint32_t>("42949672950", 4294967295U, true, "");
+        requireInt<int64_t>("9223372036854775807", INT64_MAX, false, "");
+        requireInt<int64_t>("-9223372036854775808", INT64_MIN, false, "");
+        requireInt<int64_t>("9223372036854775808", INT64_MAX, true, "");
+        requireInt<int64_t>("-9223372036854775809", INT64_MIN, true, "");
+        requireInt<uint64_t>("18446744073709551615", UINT64_MAX, false, "");
+        requireInt<uint64_t>("18446744073709551616", UINT64_MAX, true, "");
+        requireInt<uint64_t>("-18446744073709551615", 0, true, "");
+    }
+
+    SECTION("long runs of digits") {
+        // Digit blocks at every offset to the end of the integer
+        requireInt<int64_t>("1700000000123]", 1700000000123LL, false, "]");
+        requireInt<int64_t>("00000000000000000000000000000042", 42, false, "");
+        requireInt<int64_t>("123456789012345678,1", 123456789012345678LL, false, ",1");
+        requireInt<int64_t>("1234567890123456789a", 1234567890123456789LL, false, "a");
+        requireInt<int64_t>("12345678901234567890123", INT64_MAX, true, "");
+        requireInt<uint64_t>("-12345678", 0, true, "");
+        requireInt<uint64_t>("-00000000", 0, false, "");
+        requireInt<uint64_t>("99999999999999999999999999999999", UINT64_MAX, true, "");
+        requireInt<int32_t>("12345678901234567890", INT32_MAX, true, "");
+    }
+
+    SECTION("no digits") {
+        JsonParser parser;
+        parser.parse("-a", 2);
+        bool overflowed = true;
+        REQUIRE(parser.parseInt<uint64_t>(7, &overflowed) == 7);
+        REQUIRE_FALSE(overflowed);
+    }
+}
+
 TEST_CASE("JsonParser::parseNum") {
     JsonParser parser;
 
@@ -332,6 +564,101 @@ TEST_CASE("JsonParser::parseNum") {
     }
 }
 
+TEST_CASE("JsonParser::parseNumber & JsonParser::parseFixed") {
+    JsonParser parser;
+
+    SECTION("integers stay integers") {
+        std::vector<std::tuple<const char*, Number::Type, int64_t, double>> tests {
+            {"42", Number::INT, 42, 0},
+            {"-0", Number::INT, 0, 0},
+            {"00012,", Number::INT, 12, 0},
+            {"1700000000123", Number::INT, 1700000000123LL, 0},
+            {"-9223372036854775808", Number::INT, INT64_MIN, 0},
+            {"9223372036854775807", Number::INT, INT64_MAX, 0},
+            {"9223372036854775808", Number::DOUBLE, 0, 9223372036854775808.0},
+            {"123456789012345678901234567890", Number::DOUBLE, 0, 123456789012345678901234567890.0},
+            {"1.0", Number::DOUBLE, 0, 1},
+            {"-2.5e-1", Number::DOUBLE, 0, -0.25},
+            {"1E2", Number::DOUBLE, 0, 100},
+            {"", Number::NONE, 0, 0},
+            {"-a", Number::NONE, 0, 0},
+        };
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            CAPTURE(json);
+
+            parser.parse(json, std::strlen(json));
+            Number number = parser.parseNumber();
+            REQUIRE(number.type == std::get<1>(tests.at(testIdx)));
+            if(number.type == Number::INT) REQUIRE(number.integer == std::get<2>(tests.at(testIdx)));
+            if(number.type == Number::DOUBLE) REQUIRE(number.real == std::get<3>(tests.at(testIdx)));
+        }
+    }
+
+    SECTION("fixed point numbers") {
+        std::vector<std::tuple<const char*, int32_t, bool>> tests {
+            {"23.57", 2357, false},
+            {"23.5", 2350, false},
+            {"23", 2300, false},
+            {"-23.57,", -2357, false},
+            {"23.574", 2357, false},
+            {"23.575", 2358, false}, // Half away from zero
+            {"-23.575", -2358, false},
+            {"0.005", 1, false},
+            {"0.0049999", 0, false},
+            {"2.357e1", 2357, false},
+            {"2357E-2", 2357, false},
+            {"1e-10", 0, false},
+            {"0.00000000000000000000000000001", 0, false},
+            {"21474836.47", INT32_MAX, false},
+            {"-21474836.48", INT32_MIN, false},
+            {"21474836.48", INT32_MAX, true},
+            {"-21474836.485", INT32_MIN, true}, // Overflows by rounding
+            {"1e300", INT32_MAX, true},
+            {"a", -1, false},
+        };
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            CAPTURE(json);
+
+            parser.parse(json, std::strlen(json));
+            bool overflowed = !std::get<2>(tests.at(testIdx));
+            REQUIRE(parser.parseFixed<2>(-1, &overflowed) == std::get<1>(tests.at(testIdx)));
+            REQUIRE(overflowed == std::get<2>(tests.at(testIdx)));
+        }
+
+        // Other scales and types
+        parser.parse("2.5", 3);
+        REQUIRE(parser.parseFixed<0>() == 3);
+        parser.parse("1234567890123.4567", 18);
+        REQUIRE(parser.parseFixed<3, int64_t>() == 1234567890123457LL);
+        parser.parse("1.2345678901234567890123", 24);
+        REQUIRE(parser.parseFixed<18, int64_t>() == 1234567890123456789LL);
+        parser.parse("1.2345678901234567890623", 24);
+        REQUIRE(parser.parseFixed<19, uint64_t>() == 12345678901234567891ULL);
+        bool overflowed = false;
+        parser.parse("-0.5", 4);
+        REQUIRE(parser.parseFixed<1, uint16_t>(7, &overflowed) == 0);
+        REQUIRE(overflowed);
+
+        // Tiny negative numbers that round away from zero saturate at 0 as well, those rounding to zero don't overflow
+        parser.parse("-0.005", 6);
+        REQUIRE(parser.parseFixed<2, uint32_t>(7, &overflowed) == 0);
+        REQUIRE(overflowed);
+        parser.parse("-0.6", 4);
+        REQUIRE(parser.parseFixed<0, uint8_t>(7, &overflowed) == 0);
+        REQUIRE(overflowed);
+        parser.parse("-0.004", 6);
+        REQUIRE(parser.parseFixed<2, uint32_t>(7, &overflowed) == 0);
+        REQUIRE_FALSE(overflowed);
+        parser.parse("-0.6", 4);
+        REQUIRE(parser.parseFixed<0, int8_t>(7, &overflowed) == -1);
+        REQUIRE_FALSE(overflowed);
+    }
+}
+
 TEST_CASE("JsonParser::parseBool") {
     JsonParser parser;
 
@@ -481,6 +808,32 @@ TEST_CASE("Parse Int Array") {
         } 
     }
 
+    SECTION("out of range integers") {
+        JsonParser parser;
+        const char* json = "[127, -128, 128, -1000, 5] [1700000000123, 9223372036854775808, 2] [255,256,-3,0]";
+        parser.parse(json, std::strlen(json));
+
+        std::vector<int8_t> bytes;
+        bool overflowed = false;
+        REQUIRE(parser.parseIntArray(bytes, false, &overflowed));
+        REQUIRE(overflowed);
+        REQUIRE(bytes == std::vector<int8_t>{127, -128, 127, -128, 5});
+
+        std::vector<int64_t> timestamps;
+        REQUIRE(parser.parseIntArray(timestamps, false, &overflowed));
+        REQUIRE(overflowed);
+        REQUIRE(timestamps == std::vector<int64_t>{1700000000123LL, INT64_MAX, 2});
+
+        std::vector<uint8_t> ubytes;
+        REQUIRE(parser.parseIntArray(ubytes, false, &overflowed));
+        REQUIRE(overflowed);
+        REQUIRE(ubytes == std::vector<uint8_t>{255, 255, 0});
+
+        parser.parse("[1,2]", 5);
+        REQUIRE(parser.parseIntArray(ubytes, false, &overflowed));
+        REQUIRE_FALSE(overflowed);
+    }
+
     SECTION("invalid arrays") {
         std::vector<std::tuple<const char*, bool, std::vector<long>, const char*>> tests {
             {"[1,-2,3", false, {1, -2}, ""},
@@ -515,6 +868,123 @@ TEST_CASE("Parse Int Array") {
     }
 }
 
+TEST_CASE("Parse arrays into buffers") {
+    JsonParser parser;
+    const char* json = "[1, -2, 3, 4, 5, 6, 7], suffix";
+
+    SECTION("fixed-capacity buffers") {
+        for(size_t size : {0, 3, 7, 10}) {
+            CAPTURE(size);
+
+            int16_t ints[10] = {};
+            size_t count = 0;
+            parser.parse(json, std::strlen(json));
+            REQUIRE(parser.parseIntArray(ints, size, &count));
+            REQUIRE(count == 7);
+            for(size_t i = 0; i < 10; i++) REQUIRE(ints[i] == (i >= size || i >= 7 ? 0 : i == 1 ? -2 : static_cast<int16_t>(i + 1)));
+            REQUIRE(parser.skipWhitespace() == ',');
+
+            double nums[10] = {};
+            parser.parse(json, std::strlen(json));
+            REQUIRE(parser.parseNumArray(nums, size, &count));
+            REQUIRE(count == 7);
+            for(size_t i = 0; i < 10; i++) REQUIRE(nums[i] == (i >= size || i >= 7 ? 0.0 : i == 1 ? -2.0 : i + 1.0));
+            REQUIRE(parser.skipWhitespace() == ',');
+        }
+
+        // Elements before the end of an invalid array are written
+        long ints[4];
+        size_t count = 0;
+        parser.parse("[1,2", 4);
+        REQUIRE_FALSE(parser.parseIntArray(ints, 4, &count));
+        REQUIRE(count == 1);
+        REQUIRE(ints[0] == 1);
+    }
+
+    SECTION("chunks") {
+        for(size_t size : {1, 3, 7, 10}) {
+            CAPTURE(size);
+
+            std::vector<size_t> lengths;
+            std::vector<long> ints;
+            long intBuf[10];
+            parser.parse(json, std::strlen(json));
+            REQUIRE(parser.parseIntArrayChunks(intBuf, size, [&](const long* chunk, size_t len) {
+                lengths.push_back(len);
+                ints.insert(ints.end(), chunk, chunk + len);
+            }));
+            REQUIRE(ints == std::vector<long>({1, -2, 3, 4, 5, 6, 7}));
+            for(size_t i = 0; i + 1 < lengths.size(); i++) REQUIRE(lengths[i] == size);
+            REQUIRE(lengths.size() == (7 + size - 1) / size);
+
+            std::vector<double> nums;
+            double numBuf[10];
+            parser.parse(json, std::strlen(json));
+            REQUIRE(parser.parseNumArrayChunks(numBuf, size, [&](const double* chunk, size_t len) { nums.insert(nums.end(), chunk, chunk + len); }));
+            REQUIRE(nums == std::vector<double>({1, -2, 3, 4, 5, 6, 7}));
+        }
+
+        long buf[1];
+        parser.parse("[]", 2);
+        REQUIRE(parser.parseIntArrayChunks(buf, 1, [](const long* chunk, size_t len) { FAIL("no elements"); }));
+        parser.parse("[1]", 3);
+        REQUIRE_FALSE(parser.parseIntArrayChunks(buf, 0, [](const long* chunk, size_t len) {}));
+    }
+}
+
+TEST_CASE("Parse arrays from the window") {
+    // Long arrays are parsed block by block from the window, the results have to match the ones read char by char
+    JsonParser parser;
+    std::string elements[] = {
+        "0", "-0", "7", "-42", "123456789", "-9223372036854775808", "9223372036854775807", "18446744073709551615",
+        "12345678901234567890", "1.5", "-0.001", "3.14159265358979", "1e5", "-2.5E-3", "6.02e+23", "1e400", "0.1e-400",
+        " 12 ", "\n\t-3\r", "4 5", "-", "1-", "--1", "+1", "1.", ".5", "1e", "1e+", "\"17\"", "x9", ""
+    };
+
+    uint64_t seed = 1;
+    for(int testIdx = 0; testIdx < 200; testIdx++) {
+        std::string json = "[";
+        int count = 1 + testIdx % 60;
+        for(int i = 0; i < count; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            json += elements[(seed >> 33) % (testIdx < 100 ? 17 : sizeof(elements)/sizeof(elements[0]))];
+            if(i + 1 < count) json += (seed >> 40) % 3 ? "," : ", ";
+        }
+        json += "], 1";
+        CAPTURE(testIdx);
+        CAPTURE(json);
+
+        std::vector<double> nums, streamNums;
+        parser.parse(json.c_str(), json.size());
+        REQUIRE(parser.parseNumArray(nums));
+        int next = parser.skipWhitespace();
+        ArduinoTestUtils::MockStream numStream(json.c_str());
+        parser.parse(numStream);
+        REQUIRE(parser.parseNumArray(streamNums));
+        REQUIRE(next == parser.skipWhitespace());
+        REQUIRE(nums.size() == streamNums.size());
+        for(size_t i = 0; i < nums.size(); i++) REQUIRE(std::memcmp(&nums[i], &streamNums[i], sizeof(double)) == 0); // Incl. the sign of zeros
+
+        std::vector<int8_t> smallInts, streamSmallInts;
+        bool overflowed = false, streamOverflowed = false;
+        parser.parse(json.c_str(), json.size());
+        REQUIRE(parser.parseIntArray(smallInts, false, &overflowed));
+        ArduinoTestUtils::MockStream smallIntStream(json.c_str());
+        parser.parse(smallIntStream);
+        REQUIRE(parser.parseIntArray(streamSmallInts, false, &streamOverflowed));
+        REQUIRE(smallInts == streamSmallInts);
+        REQUIRE(overflowed == streamOverflowed);
+
+        std::vector<uint64_t> unsignedInts, streamUnsignedInts;
+        parser.parse(json.c_str(), json.size());
+        REQUIRE(parser.parseIntArray(unsignedInts));
+        ArduinoTestUtils::MockStream unsignedIntStream(json.c_str());
+        parser.parse(unsignedIntStream);
+        REQUIRE(parser.parseIntArray(streamUnsignedInts));
+        REQUIRE(unsignedInts == streamUnsignedInts);
+    }
+}
+
 TEST_CASE("Parse Num Array") {
     JsonParser parser;
 
@@ -622,6 +1092,12 @@ TEST_CASE("JsonParser::compilePath", "[compilePath]") {
     JsonParser parser;
 
     SECTION("Valid paths") {
+        // Segments only refer to their predicates
+        PathPredicate sensor{"type", PredicateOp::EQ, PathPredicate::STRING, "sensor", 0};
+        PathPredicate temp{"temp", PredicateOp::GE, PathPredicate::NUMBER, "-20.5", -20.5};
+        PathPredicate on{"on", PredicateOp::NE, PathPredicate::TOKEN, "true", 0};
+        PathPredicate quoted{"a<b", PredicateOp::LT, PathPredicate::STRING, "x'y", 0};
+
         std::vector<std::tuple<const char*, std::vector<PathSegment>>> tests {
             {"thekey", {{"thekey"}}},
             {"obj1/thekey", {{"obj1"}, {"thekey"}}},
@@ -643,6 +1119,25 @@ TEST_CASE("JsonParser::compilePath", "[compilePath]") {
             {"obj[1][2][3]", {{"obj"}, {1}, {2}, {3}}},
             {"obj1[1]/obj2[2]/obj3[3]/obj4", {{"obj1"}, {1}, {"obj2"}, {2}, {"obj3"}, {3}, {"obj4"}}},
 
+            // Wildcards
+            {"books[*]/author", {{"books"}, {PathSegmentType::ANY_OFFSET}, {"author"}}},
+            {"*/id", {{PathSegmentType::ANY_KEY}, {"id"}}},
+            {"obj/*[1]/*", {{"obj"}, {PathSegmentType::ANY_KEY}, {1}, {PathSegmentType::ANY_KEY}}},
+            {"\\*/a*", {{"*"}, {"a*"}}},
+
+            // Descendants
+            {"..id", {{PathSegmentType::DESCENDANT}, {"id"}}},
+            {"obj..id", {{"obj"}, {PathSegmentType::DESCENDANT}, {"id"}}},
+            {"[2]..id[1]", {{2}, {PathSegmentType::DESCENDANT}, {"id"}, {1}}},
+            {"**/id", {{PathSegmentType::DESCENDANT}, {"id"}}},
+            {"obj/**", {{"obj"}, {PathSegmentType::DESCENDANT}}},
+            {"a.b/a\\..b", {{"a.b"}, {"a..b"}}},
+
+            // Predicates
+            {"items[?type==\"sensor\"]/value", {{"items"}, PathSegment(sensor), {"value"}}},
+            {"[?temp>=-20.5][?on!=true]", {PathSegment(temp), PathSegment(on)}},
+            {"[?a\\<b<'x\\'y']..id", {PathSegment(quoted), {PathSegmentType::DESCENDANT}, {"id"}}},
+
             // UTF-8
             {"ä/ö/ü", {{"ä"}, {"ö"}, {"ü"}}},
             {"😀😃😄/😁😆😅/🤣😂🙂", {{"😀😃😄"}, {"😁😆😅"}, {"🤣😂🙂"}}},
@@ -660,13 +1155,82 @@ TEST_CASE("JsonParser::compilePath", "[compilePath]") {
                 REQUIRE(path.at(i).type == expected_vec.at(i).type);
                 if(path.at(i).type == PathSegmentType::OFFSET) {
                     REQUIRE(path.at(i).val.offset == expected_vec.at(i).val.offset);
-                } else {
+                } else if(path.at(i).type == PathSegmentType::KEY) {
                     CHECK_THAT(path.at(i).val.key, Catch::Matchers::Equals(expected_vec.at(i).val.key));
+                } else if(path.at(i).type == PathSegmentType::PREDICATE) {
+                    const PathPredicate& predicate = *path.at(i).val.predicate;
+                    const PathPredicate& expected = *expected_vec.at(i).val.predicate;
+                    CHECK_THAT(predicate.key.c_str(), Catch::Matchers::Equals(expected.key.c_str()));
+                    CHECK(predicate.op == expected.op);
+                    CHECK(predicate.kind == expected.kind);
+                    CHECK_THAT(predicate.text.c_str(), Catch::Matchers::Equals(expected.text.c_str()));
+                    CHECK(predicate.number == expected.number);
                 }
             }
         }
     }
 
+    SECTION("Path literals") {
+        // Parsed at compile time
+        static constexpr auto path = JSTREAM_PATH("obj1[1]/\\/the\\[key/*[*]");
+        static_assert(path.isValid && path.size() == 5, "Path literal wasn't parsed");
+        static_assert(path.segments[1].type == PathSegmentType::OFFSET && path.segments[1].val == 1, "Offset wasn't parsed");
+        static_assert(path.keys[path.segments[2].val] == '/' && path.keys[path.segments[2].val + 4] == '[', "Key wasn't unescaped");
+
+        // Same segments as a path parsed at runtime
+        Path expected = Path("obj1[1]/\\/the\\[key/*[*]");
+        REQUIRE(expected.size() == path.size());
+        for(size_t i=0; i<path.size(); i++) {
+            REQUIRE(path.segments[i].type == expected.at(i).type);
+            if(expected.at(i).type == PathSegmentType::OFFSET) {
+                CHECK(path.segments[i].val == expected.at(i).val.offset);
+            } else if(expected.at(i).type == PathSegmentType::KEY) {
+                CHECK_THAT(path.keys + path.segments[i].val, Catch::Matchers::Equals(expected.at(i).val.key));
+            }
+        }
+
+        // Invalid paths are only detected at runtime, if they aren't constructed with JSTREAM_PATH()
+        CHECK_FALSE(StaticPath<2, 7>("a..b/c").isValid);
+        CHECK_FALSE(StaticPath<1, 5>("[1x]").isValid);
+    }
+
+    SECTION("Invalid predicates") {
+        std::vector<const char*> tests = {"[?type=\"x\"]", "[?==1]", "[?a==]", "[?a==1x]", "[?a<true]", "[?a=='x]", "[?a==1]b", "[?a==1", "[?abc"};
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* path_str = tests.at(testIdx);
+            CAPTURE(path_str);
+            CHECK_FALSE(Path(path_str).isValid);
+        }
+    }
+
+    SECTION("Appending and moving") {
+        Path path = Path("items[?id==1]");
+        REQUIRE(path.append("name/first"));
+        CHECK_FALSE(path.append("[1x]"));
+        REQUIRE(path.size() == 4);
+
+        // Keys and predicates were moved into the new block
+        Path moved = std::move(path);
+        CHECK(path.size() == 0);
+        REQUIRE(moved.size() == 4);
+        CHECK_THAT(moved[0].val.key, Catch::Matchers::Equals("items"));
+        CHECK_THAT(moved[1].val.predicate->key.c_str(), Catch::Matchers::Equals("id"));
+        CHECK_THAT(moved[2].val.key, Catch::Matchers::Equals("name"));
+        CHECK(moved[3].len == 5);
+
+        // Overloads kept for compatibility
+        Path hinted("a/b[2]", 8);
+        REQUIRE(hinted.isValid);
+        CHECK(hinted.size() == 3);
+        String key = "akey";
+        PathSegment segment(key);
+        CHECK(segment.type == PathSegmentType::KEY);
+        CHECK(segment.len == 4);
+        CHECK(segment.val.key == key.c_str());
+        static_assert(!std::is_constructible<PathSegment, String&&>::value, "Segments of temporary Strings would dangle");
+    }
+
     // SECTION("Invalid paths") {
     //     std::vector<std::tuple<const char*>> tests {
     //         {"obj1[1]obj2"}
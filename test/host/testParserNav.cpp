@@ -14,6 +14,7 @@
 #define protected public
 #define private   public
 #include <JsonParser.h>
+#include <StaticPath.h>
 #undef protected
 #undef private
 
@@ -135,6 +136,16 @@ TEST_CASE("JsonParser::nextKey", "[nextKey]") {
             CHECK_THAT(key.c_str(), Catch::Matchers::Equals(expected_key));
             CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
 
+            // Test capturing the key in a fixed buffer
+            stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            char buf[64];
+            size_t length = 0;
+            REQUIRE(parser.nextKey(buf, sizeof(buf), &length));
+            CHECK_THAT(buf, Catch::Matchers::Equals(expected_key));
+            CHECK(length == strlen(expected_key));
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
+
             // Test not capturing the key
             stream = ArduinoTestUtils::MockStream(json);
             parser.parse(stream);
@@ -313,6 +324,103 @@ TEST_CASE("JsonParser::findKey", "[findKey]") {
     }
 }
 
+TEST_CASE("JsonParser::nextKeyOf", "[nextKeyOf]") {
+    JsonParser parser;
+    KeySet keys = {"id", "name", "names", "\\tag\"", "äöü"};
+
+    SECTION("Json with keys of the set") {
+        // Json | key index | resulting Json
+        std::vector<std::tuple<const char*, int, const char*>> tests {
+            {"\"id\": 1, \"name\": 2}", 0, "1, \"name\": 2}"},
+            {",\n\t\r \"name\"\n :\n 2}", 1, "2}"},
+
+            // Skip unknown keys and keys that are prefixes or extensions of keys in the set
+            {"\"x\": {\"id\": 1}, \"nam\": 2, \"namesake\": 3, \"idx\": [\"id\"], \"names\": 4}", 2, "4}"},
+            {"\"i\\\"d\": 1, \"id\\u0000\": 2, \"id\": 3}", 0, "3}"},
+
+            // Skip malformed keys
+            {"\"id\" 1, 2, \"name\": 3}", 1, "3}"},
+
+            // Match escaped and non-ascii chars
+            {"\"\\\\tag\\\"\": 1}", 3, "1}"},
+            {"\"a\": 1, \"äöü\": 2}", 4, "2}"},
+        };
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            int index = std::get<1>(tests.at(testIdx));
+            const char* json_after_exec = std::get<2>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            REQUIRE(parser.nextKeyOf(keys) == index);
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
+        }
+    }
+
+    SECTION("Json without keys of the set") {
+        std::vector<std::tuple<const char*, const char*>> tests {
+            {"\"x\": 1, \"ids\": 2}, \"id\": 3", "}, \"id\": 3"},
+            {"\"nam\" : {\"id\": 1]", ""},
+            {"", ""},
+        };
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            const char* json_after_exec = std::get<1>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            REQUIRE(parser.nextKeyOf(keys) == -1);
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
+        }
+    }
+
+    SECTION("Collect keys in one pass") {
+        const char* json = "{\"name\": \"a\", \"x\": [1], \"id\": 2, \"names\": [\"b\"]}";
+        JsonParser memParser(json, strlen(json));
+        REQUIRE(memParser.enterObj());
+        REQUIRE(memParser.nextKeyOf(keys) == 1);
+        REQUIRE(memParser.nextKeyOf(keys) == 0);
+        REQUIRE(memParser.parseInt() == 2);
+        REQUIRE(memParser.nextKeyOf(keys) == 2);
+        REQUIRE(memParser.nextKeyOf(keys) == -1);
+        REQUIRE(memParser.atEnd());
+    }
+
+    SECTION("Enum-like values") {
+        KeySet values = {"red", "green", "blue"};
+        std::vector<std::tuple<const char*, int, const char*>> tests {
+            {" \"green\", 1", 1, ", 1"},
+            {"\"blue\"]", 2, "]"},
+            {"\"gree\", 1", -1, ", 1"},
+            {"\"greenish\", 1", -1, ", 1"},
+            {"\"\\u0072ed\", 1", -1, ", 1"},
+            {"red, 1", -1, "red, 1"},
+        };
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            int index = std::get<1>(tests.at(testIdx));
+            const char* json_after_exec = std::get<2>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            REQUIRE(parser.parseEnum(values) == index);
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
+        }
+    }
+}
+
 TEST_CASE("JsonParser::enterArr && ::enterObj", "[enterCollection, enterArr, enterObj]") {
     JsonParser parser;
 
@@ -496,6 +604,64 @@ TEST_CASE("JsonParser::skipCollection", "[skipCollection]") {
     }
 }
 
+TEST_CASE("JsonParser::skipValue", "[skipValue]") {
+    JsonParser parser;
+
+    SECTION("Successfull skips") {
+        std::vector<std::tuple<const char*, const char*>> tests = {
+            // Strings
+            {"\"str\", suffix", ", suffix"},
+            {" \"s\\\"]}\" , suffix", ", suffix"},
+
+            // Objects/arrays
+            {"{\"a\": [1, {}], \"b\": \"]\"}, suffix", ", suffix"},
+            {"\r\n\t [1, 2], suffix", ", suffix"},
+
+            // Numbers and literals
+            {"123.5e3 , suffix", ", suffix"},
+            {"-1\n}", "}"},
+            {"true]", "]"},
+            {"null}", "}"},
+        };
+
+		for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            const char* json_after_exec = std::get<1>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            REQUIRE(parser.skipValue());
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
+        }
+    }
+
+    SECTION("Unsuccessfull skips") {
+        std::vector<std::tuple<const char*, const char*>> tests = {
+            {"", ""},
+            {" ], suffix", "], suffix"},
+            {", 1", ", 1"},
+            {"\"unterminated", ""},
+            {"[1, 2", ""},
+        };
+
+		for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            const char* json_after_exec = std::get<1>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+            parser.parse(stream);
+            REQUIRE_FALSE(parser.skipValue());
+            CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
+        }
+    }
+}
+
 TEST_CASE("JsonParser::find", "[find]") {
     JsonParser parser;
 
@@ -531,6 +697,22 @@ TEST_CASE("JsonParser::find", "[find]") {
 
             // Escaped chars
             {",\"\\\"thekey\\\"\": 1}", "\"thekey\"", "1}"},
+            {"\"a/b\": 1, \"a/b[1]*\": 2}", "a\\/b\\[1]\\*", "2}"},
+            {"\"obj\": {\"x\\\\\\\\/y\": 1}}", "obj/x\\\\\\/y", "1}}"},
+
+            // Wildcards find the first element
+            {"\"akey\": 1, \"thekey\": 2}", "*", "1, \"thekey\": 2}"},
+            {", \"akey\": {\"thekey\": 2}}", "*/thekey", "2}}"},
+            {"[1,2,3], [4,5,6]]", "[*][1]", "2,3], [4,5,6]]"},
+
+            // Descendants find the first match at any depth
+            {"\"a\": {\"b\": [1, {\"id\": 2}]}, \"id\": 3}", "..id", "2}]}, \"id\": 3}"},
+            {"\"id\": 1, \"a\": {\"id\": 2}}", "a..id", "2}}"},
+            {"[{\"x\": {\"id\": 1}}], {\"id\": 2}]", "[1]/**/id", "2}]"},
+
+            // Predicates find the first member of a matching element
+            {"\"items\": [{\"type\": \"a\", \"value\": 1}, {\"type\": \"sensor\", \"value\": 2}]}", "items[?type=='sensor']/value", "2}]}"},
+            {"{\"id\": 1}, {\"id\": 3, \"on\": false}, {\"on\": true, \"id\": 4}]", "[?id>2]/on", "false}, {\"on\": true, \"id\": 4}]"},
 
             // UTF-8
             {"\"obj1\": {\"äöüÄÖÜ\": 1}}", "obj1/äöüÄÖÜ", "1}}"},
@@ -564,6 +746,8 @@ TEST_CASE("JsonParser::find", "[find]") {
             // Index out of bounds
             {"0, 1, 2, 3, 4]", "[5]", "]"},
             {"[1,2,3], [3,4,5], [6,7,8]]", "[1][3]", "], [6,7,8]]"},
+            {"\"a\": {\"b\": [1, {\"x\": 2}]}, \"id\": 3}", "a..id", "}"},
+            {"\"items\": [{\"type\": \"a\", \"value\": 1}, {\"value\": 2}]}", "items[?type=='sensor']/value", "}"},
         };
 
 		for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
@@ -583,4 +767,288 @@ TEST_CASE("JsonParser::find", "[find]") {
             CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(json_after_exec));
         }
     }
-}
\ No newline at end of file
+
+    SECTION("Path literals") {
+        const char* json = "\"obj1\": {\"arr1\": [{\"akey\": 1}, {\"akey\": 1, \"the/key\": 2}]}, \"akey\": 3}";
+        static constexpr auto path = JSTREAM_PATH("obj1/arr1[1]/the\\/key");
+        static constexpr auto missing = JSTREAM_PATH("obj1/arr1[2]");
+
+        ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+        parser.parse(stream);
+        REQUIRE(parser.find(path));
+        CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals("2}]}, \"akey\": 3}"));
+
+        stream = ArduinoTestUtils::MockStream(json);
+        parser.parse(stream);
+        REQUIRE_FALSE(parser.find(missing));
+        CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals("]}, \"akey\": 3}"));
+    }
+
+    SECTION("Predicate after the found member") {
+        // The buffered value is read before the rest of the element
+        const char* json = "\"items\": [{\"value\": [1, 2], \"type\": \"x\"}, {\"value\": [3, 4], \"type\": \"sensor\", \"id\": 5}], \"next\": 6}";
+        std::vector<int> values;
+
+        ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(json);
+        parser.parse(stream);
+        REQUIRE(parser.find("items[?type==\"sensor\"]/value"));
+        REQUIRE(parser.parseIntArray(values));
+        CHECK(values == std::vector<int>({3, 4}));
+        REQUIRE(parser.findKey("id"));
+        CHECK(parser.parseInt() == 5);
+        CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals("}], \"next\": 6}"));
+
+        values.clear();
+        parser.parse(json, strlen(json));
+        REQUIRE(parser.find("items[?type==\"sensor\"]/value"));
+        REQUIRE(parser.parseIntArray(values));
+        CHECK(values == std::vector<int>({3, 4}));
+        REQUIRE(parser.exitCollection(2));
+        REQUIRE(parser.findKey("next"));
+        CHECK(parser.parseInt() == 6);
+    }
+}
+
+TEST_CASE("JsonParser::query", "[query]") {
+    const char* weather = "{\"coord\": {\"lon\": 10.99, \"lat\": 44.34}, \"weather\": [{\"id\": 501, \"main\": \"Rain\"}, {\"id\": 300, \"main\": \"Drizzle\"}],"
+        " \"main\": {\"temp\": 298, \"humidity\": 64}, \"wind\": {\"speed\": 0.62, \"deg\": 349}, \"sys\": {\"sunrise\": 1661834187}}, \"rest\"";
+
+    SECTION("Paths in any order") {
+        Query query = {"sys/sunrise", "main/temp", "weather[0]/main", "wind/speed", "missing/key", "weather[5]"};
+        REQUIRE(query.isValid);
+
+        std::vector<std::pair<size_t, double>> matches;
+        String main;
+        ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(weather);
+        JsonParser parser(stream);
+        bool success = parser.query(query, [&](size_t path) {
+            if(path == 2) parser.readString(main);
+            matches.push_back({path, path == 2 ? 0 : parser.parseNum()});
+        });
+
+        REQUIRE(success);
+        CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(", \"rest\""));
+        CHECK_THAT(main.c_str(), Catch::Matchers::Equals("Rain"));
+        REQUIRE(matches.size() == 4);
+        CHECK(matches[0].first == 2);
+        CHECK(matches[1].first == 1);
+        CHECK(matches[1].second == 298);
+        CHECK(matches[2].first == 3);
+        CHECK(matches[2].second == Approx(0.62));
+        CHECK(matches[3].first == 0);
+        CHECK(matches[3].second == 1661834187.0);
+    }
+
+    SECTION("Shared prefixes") {
+        // Keys and offsets leading to the same value, paths leading through the value of another path
+        Query query = {"weather[1]/id", "[1][1]/main", "weather", "weather[1]", "[5]"};
+        REQUIRE(query.isValid);
+
+        std::vector<size_t> matches;
+        JsonParser parser(weather, strlen(weather));
+        REQUIRE(parser.query(query, [&](size_t path) { matches.push_back(path); }));
+        REQUIRE(parser.skipWhitespace() == ',');
+        CHECK(matches == std::vector<size_t>({2, 3, 0, 1}));
+
+        // The callback reads the value of a path leading through it
+        matches.clear();
+        parser.parse(weather, strlen(weather));
+        REQUIRE(parser.query(query, [&](size_t path) {
+            matches.push_back(path);
+            if(path == 2) parser.skipCollection();
+        }));
+        CHECK(matches == std::vector<size_t>({2}));
+    }
+
+    SECTION("More keys than the visited keys mask has bits") {
+        std::string json = "{";
+        std::vector<std::string> labels;
+        for(int i = 0; i < 70; i++) {
+            labels.push_back("k" + std::to_string(i));
+            json += (i ? ", \"" : "\"") + labels.back() + "\": " + std::to_string(i);
+        }
+        json += "}";
+        std::vector<Path> paths;
+        for(const std::string& label : labels) paths.emplace_back(label.c_str());
+        Query query(paths.data(), paths.size());
+        REQUIRE(query.isValid);
+
+        std::vector<size_t> matches;
+        JsonParser parser(json.c_str(), json.size());
+        REQUIRE(parser.query(query, [&](size_t path) { REQUIRE(parser.parseNum() == path); matches.push_back(path); }));
+        REQUIRE(matches.size() == 70);
+        REQUIRE(parser.read() == -1);
+    }
+
+    SECTION("Invalid json") {
+        std::vector<const char*> tests = {"", "{\"main\": {\"temp\": 1", "{\"main\": {\"humidity\": [1, 2", "{\"a\": \"b"};
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = tests.at(testIdx);
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            Query query = {"main/temp"};
+            JsonParser parser(json, strlen(json));
+            REQUIRE_FALSE(parser.query(query, [&](size_t path) {}));
+        }
+    }
+}
+
+TEST_CASE("JsonParser::forEach", "[forEach]") {
+    const char* books = "{\"books\": [{\"author\": \"A\", \"tags\": [\"x\"]}, {\"title\": \"T\", \"author\": \"B\"}, 1, {\"author\": \"C\"}],"
+        " \"author\": \"D\", \"shelf\": {\"a\": {\"author\": \"E\"}, \"b\": [{\"author\": \"F\"}]}}, \"rest\"";
+
+    // Path | authors
+    std::vector<std::tuple<const char*, const char*>> tests = {
+        {"books[*]/author", "ABC"},
+        {"books[*]/*", "ATBC"},
+        {"[*]/author", ""},
+        {"*", "D"},
+        {"shelf/*/author", "E"},
+        {"shelf/b[*]/author", "F"},
+        {"books[5]/author", ""},
+    };
+
+    for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+        const char* path_str = std::get<0>(tests.at(testIdx));
+        const char* authors = std::get<1>(tests.at(testIdx));
+
+        CAPTURE(testIdx);
+        CAPTURE(path_str);
+
+        // Strings are read, other values are skipped
+        String read = "";
+        ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(books);
+        JsonParser parser(stream);
+        REQUIRE(parser.forEach(path_str, [&]() {
+            String value;
+            if(parser.readString(value) && value.length() == 1) read += value;
+        }));
+        CHECK_THAT(read.c_str(), Catch::Matchers::Equals(authors));
+        CHECK_THAT(stream.readString().c_str(), Catch::Matchers::Equals(", \"rest\""));
+    }
+
+    SECTION("Wildcards and offsets") {
+        Query query = {"books[*]/author", "books[1]/title", "*/b[*]/author"};
+        REQUIRE(query.isValid);
+
+        String read = "";
+        JsonParser parser(books, strlen(books));
+        REQUIRE(parser.query(query, [&](size_t path) {
+            String value;
+            parser.readString(value);
+            read += static_cast<char>('0' + path);
+            read += value.c_str();
+        }));
+        CHECK_THAT(read.c_str(), Catch::Matchers::Equals("0A1T0B0C2F"));
+    }
+
+    SECTION("Descendants") {
+        const char* records = "[{\"id\": 1, \"data\": {\"id\": 2}}, {\"type\": \"x\", \"items\": [{\"meta\": {\"id\": 3}}, 4]}, {\"id\": {\"id\": 5}}]";
+
+        String read = "";
+        JsonParser parser(records, strlen(records));
+        REQUIRE(parser.forEach("..id", [&]() {
+            if(parser.skipWhitespace() != '{') read += static_cast<char>('0' + parser.parseInt());
+        }));
+        CHECK_THAT(read.c_str(), Catch::Matchers::Equals("1235"));
+
+        // Deeper values aren't walked
+        Query query = {"**/id"};
+        query.maxDepth = 3;
+        read = "";
+        parser.parse(records, strlen(records));
+        REQUIRE(parser.query(query, [&](size_t path) {
+            if(parser.skipWhitespace() != '{') read += static_cast<char>('0' + parser.parseInt());
+        }));
+        CHECK_THAT(read.c_str(), Catch::Matchers::Equals("125"));
+    }
+
+    SECTION("Predicates") {
+        const char* records = "[{\"type\": \"sensor\", \"value\": 1}, {\"value\": 2, \"type\": \"sensor\"}, {\"value\": 3, \"type\": \"relay\"},"
+            " {\"type\": \"relay\", \"value\": 4}, {\"value\": 5, \"id\": 7, \"type\": \"sensor\"}, {\"value\": 6}, 8]";
+
+        // Path | read values
+        std::vector<std::tuple<const char*, const char*>> tests = {
+            {"[?type=='sensor']/value", "125"},
+            {"[?type!='sensor']/value", "34"},
+            {"[?value>=4]/id", "7"},
+            {"[?value<3]/type", "ss"},
+            {"[?type=='sensor'][0]", "25"}, // Compared members aren't walked
+            {"[?id==7]/value", "5"},
+            {"[?type==null]/value", ""},
+        };
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* path_str = std::get<0>(tests.at(testIdx));
+            const char* values = std::get<1>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(path_str);
+
+            // Only the first char of strings is read
+            String read = "";
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(records);
+            JsonParser parser(stream);
+            REQUIRE(parser.forEach(path_str, [&]() {
+                String value;
+                if(parser.skipWhitespace() == '"' && parser.readString(value)) read += value.c_str()[0];
+                else read += static_cast<char>('0' + parser.parseInt());
+            }));
+            CHECK_THAT(read.c_str(), Catch::Matchers::Equals(values));
+            CHECK(stream.readString().length() == 0);
+        }
+
+        // Several predicates on the same member
+        Query dispatch = {"[?type=='sensor']/value", "[?type=='relay']/value"};
+        String read = "";
+        JsonParser parser(records, strlen(records));
+        REQUIRE(parser.query(dispatch, [&](size_t path) {
+            read += static_cast<char>('0' + path);
+            read += static_cast<char>('0' + parser.parseInt());
+        }));
+        CHECK_THAT(read.c_str(), Catch::Matchers::Equals("0102131405"));
+
+        // ... that is longer than the buffer, it is compared while it streams past
+        std::string longName(100, 'x');
+        std::string named = "[{\"v\": 1, \"n\": \"" + longName + "\"}, {\"n\": \"a\", \"v\": 2}, {\"n\": \"" + longName + "b\", \"v\": 3}]";
+        Query unequal = {"[?n!='a']/v", "[?n!='b']/v", "[?n>='x']/v", ("[?n=='" + longName + "']/v").c_str()};
+        read = "";
+        parser.parse(named.c_str(), named.size());
+        long value = 0;
+        REQUIRE(parser.query(unequal, [&](size_t path) {
+            if(parser.skipWhitespace() != ',' && parser.peek() != '}') value = parser.parseInt(); // Only the first path reads the value
+            read += static_cast<char>('0' + path);
+            read += static_cast<char>('0' + value);
+        }));
+        CHECK_THAT(read.c_str(), Catch::Matchers::Equals("0111213112031323"));
+
+        // Values that don't fit into the buffer are skipped
+        Query query = {"[?type=='sensor']/value"};
+        query.bufferSize = 0;
+        read = "";
+        parser.parse(records, strlen(records));
+        REQUIRE(parser.query(query, [&](size_t path) { read += static_cast<char>('0' + parser.parseInt()); }));
+        CHECK_THAT(read.c_str(), Catch::Matchers::Equals("1"));
+
+        // A path can't end with a predicate, the matching element is only known after it was walked
+        CHECK_FALSE(Query({"[?type=='sensor']"}).isValid);
+    }
+
+    SECTION("Array of objects") {
+        std::string json = "[";
+        for(int i = 0; i < 1000; i++) json += std::string(i ? "," : "") + "{\"id\": " + std::to_string(i) + ", \"tags\": [\"a\", {\"id\": -1}]}";
+        json += "]";
+
+        long sum = 0;
+        size_t count = 0;
+        JsonParser parser(json.data(), json.size());
+        REQUIRE(parser.forEach("[*]/id", [&]() {
+            sum += parser.parseInt();
+            count++;
+        }));
+        CHECK(count == 1000);
+        CHECK(sum == 999*1000/2);
+    }
+}
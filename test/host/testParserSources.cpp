@@ -0,0 +1,615 @@
+#include "catch.hpp"
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <utility>
+#include <cstring>
+#include <sstream>
+#include <cmath>
+
+#include <Arduino.h>
+#include <MockStream.h>
+
+#define protected public
+#define private   public
+#include <JsonParser.h>
+#undef protected
+#undef private
+
+#include <Path.h>
+
+using namespace JStream;
+
+/** @brief Reads the remaining input of a parser, including the chars buffered in its window */
+static String readRemaining(JsonParser& parser) {
+    String str = "";
+    int c;
+    while((c = parser.read()) >= 0) str += (char)c;
+    return str;
+}
+
+static const char* BOOKS_JSON =
+    "{\n"
+    "    \"books\": [\n"
+    "        {\n"
+    "            \"title\": \"The Hobbit\",\n"
+    "            \"author\": \"J. R. R. Tolkien\",\n"
+    "            \"tags\": [\"fantasy\", {\"\\\"quoted\\\"\": \"]}\"}]\n"
+    "        },\n"
+    "        {\n"
+    "            \"title\": \"The NeverEnding Story\",\n"
+    "            \"author\": \"Michael Ende\",\n"
+    "            \"year\": 1979,\n"
+    "            \"rating\": 4.25e-1\n"
+    "        }\n"
+    "    ]\n"
+    "}, suffix";
+
+TEST_CASE("Buffered JsonParser", "[buffered]") {
+    std::vector<size_t> bufSizes {1, 2, 3, 7, 16, 1024};
+    char buf[1024];
+
+    SECTION("find & read values") {
+        for(size_t bufSize : bufSizes) {
+            CAPTURE(bufSize);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(BOOKS_JSON);
+            JsonParser parser(stream, buf, bufSize);
+
+            REQUIRE(parser.enterObj());
+            REQUIRE(parser.find("books[1]/author"));
+            String author = "";
+            REQUIRE(parser.readString(author));
+            CHECK_THAT(author.c_str(), Catch::Matchers::Equals("Michael Ende"));
+
+            REQUIRE(parser.findKey("year"));
+            REQUIRE(parser.parseInt() == 1979);
+            REQUIRE(parser.findKey("rating"));
+            REQUIRE(parser.parseNum() == Approx(0.425));
+
+            REQUIRE(parser.exitCollection(3));
+            CHECK_THAT(readRemaining(parser).c_str(), Catch::Matchers::Equals(", suffix"));
+        }
+    }
+
+    SECTION("skip values") {
+        for(size_t bufSize : bufSizes) {
+            CAPTURE(bufSize);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream(BOOKS_JSON);
+            JsonParser parser(stream, buf, bufSize);
+
+            Path path = Path("books[0]/tags[1]");
+            REQUIRE(parser.enterObj());
+            REQUIRE(parser.find(path));
+            REQUIRE(parser.skipCollection());
+            REQUIRE_FALSE(parser.nextVal());
+            REQUIRE(parser.exitCollection());
+            REQUIRE_FALSE(parser.nextKey(nullptr));
+            REQUIRE(parser.exitCollection());
+            REQUIRE(parser.nextVal());
+
+            String key = "";
+            REQUIRE(parser.enterObj());
+            REQUIRE(parser.nextKey(&key));
+            CHECK_THAT(key.c_str(), Catch::Matchers::Equals("title"));
+            REQUIRE(parser.strcmp("The NeverEnding Story") == 0);
+            REQUIRE(parser.nextKey(nullptr));
+            REQUIRE(parser.skipString());
+            REQUIRE(parser.exitCollection(3));
+            CHECK_THAT(readRemaining(parser).c_str(), Catch::Matchers::Equals(", suffix"));
+        }
+    }
+
+    SECTION("parse arrays") {
+        for(size_t bufSize : bufSizes) {
+            CAPTURE(bufSize);
+
+            ArduinoTestUtils::MockStream stream = ArduinoTestUtils::MockStream("[1, -22, 333], [1.5, -2.25e1, 3], suffix");
+            JsonParser parser(stream, buf, bufSize);
+
+            std::vector<long> ints;
+            REQUIRE(parser.parseIntArray(ints));
+            REQUIRE(ints == std::vector<long>({1, -22, 333}));
+
+            std::vector<double> nums;
+            REQUIRE(parser.nextVal());
+            REQUIRE(parser.parseNumArray(nums));
+            REQUIRE(nums == std::vector<double>({1.5, -22.5, 3}));
+
+            CHECK_THAT(readRemaining(parser).c_str(), Catch::Matchers::Equals(", suffix"));
+        }
+    }
+}
+
+TEST_CASE("In-memory JsonParser", "[memory]") {
+    SECTION("find & read values") {
+        JsonParser parser(BOOKS_JSON, std::strlen(BOOKS_JSON));
+
+        REQUIRE(parser.enterObj());
+        REQUIRE(parser.find("books[1]/author"));
+        String author = "";
+        REQUIRE(parser.readString(author));
+        CHECK_THAT(author.c_str(), Catch::Matchers::Equals("Michael Ende"));
+
+        REQUIRE(parser.findKey("rating"));
+        REQUIRE(parser.parseNum() == Approx(0.425));
+
+        REQUIRE(parser.exitCollection(3));
+        CHECK_THAT(readRemaining(parser).c_str(), Catch::Matchers::Equals(", suffix"));
+    }
+
+    SECTION("view strings") {
+        // Json | inStr | expected view | resulting Json
+        std::vector<std::tuple<const char*, bool, const char*, const char*>> tests = {
+            {"\"\", suffix", false, "", ", suffix"},
+            {"\"astring\", suffix", false, "astring", ", suffix"},
+            {"\r\n\t \"astring\", suffix", false, "astring", ", suffix"},
+            {"astring\", suffix", true, "astring", ", suffix"},
+            {"äöüÄÖÜ\"", true, "äöüÄÖÜ", ""},
+        };
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            const bool inStr = std::get<1>(tests.at(testIdx));
+            const char* expected_str = std::get<2>(tests.at(testIdx));
+            const char* json_after_exec = std::get<3>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            JsonParser parser(json, std::strlen(json));
+            StringView view;
+            REQUIRE(parser.readString(view, inStr));
+            REQUIRE(view.data >= json);
+            REQUIRE(view.data + view.length <= json + std::strlen(json));
+            CHECK(std::string(view.data, view.length) == expected_str);
+            CHECK_THAT(readRemaining(parser).c_str(), Catch::Matchers::Equals(json_after_exec));
+        }
+    }
+
+    SECTION("strings that can't be viewed") {
+        // Json | inStr | resulting Json
+        std::vector<std::tuple<const char*, bool, const char*>> tests = {
+            {"\"a\\\"string\", suffix", false, "\"a\\\"string\", suffix"},
+            {"a\\nstring\", suffix", true, "a\\nstring\", suffix"},
+            {"\r\n\t \"astring", false, "\"astring"},
+            {"", true, ""},
+            {"123", false, "123"},
+        };
+
+        for(unsigned int testIdx=0; testIdx<tests.size(); testIdx++) {
+            const char* json = std::get<0>(tests.at(testIdx));
+            const bool inStr = std::get<1>(tests.at(testIdx));
+            const char* json_after_exec = std::get<2>(tests.at(testIdx));
+
+            CAPTURE(testIdx);
+            CAPTURE(json);
+
+            JsonParser parser(json, std::strlen(json));
+            StringView view;
+            REQUIRE_FALSE(parser.readString(view, inStr));
+            CHECK_THAT(readRemaining(parser).c_str(), Catch::Matchers::Equals(json_after_exec));
+        }
+    }
+
+    SECTION("read long strings") {
+        std::string expected = "";
+        std::string json = "\"";
+        for(int i = 0; i < 100; i++) {
+            expected += "0123456789abcdefghijklmnopqrstuvwxyz\"/";
+            json += "0123456789abcdefghijklmnopqrstuvwxyz\\\"\\/";
+        }
+        json += "\"";
+
+        JsonParser parser(json.c_str(), json.size());
+        String str = "";
+        REQUIRE(parser.readString(str));
+        CHECK(str == expected.c_str());
+        REQUIRE(parser.atEnd());
+    }
+
+    SECTION("view keys") {
+        const char* json = "\"akey\": 1, [1, 2], \"bkey\" : {\"ckey\": 3}, \"d\\\"key\": 4}";
+        JsonParser parser(json, std::strlen(json));
+        StringView key;
+
+        REQUIRE(parser.nextKey(key));
+        CHECK(std::string(key.data, key.length) == "akey");
+        REQUIRE(parser.nextKey(key));
+        CHECK(std::string(key.data, key.length) == "bkey");
+        REQUIRE_FALSE(parser.nextKey(key));
+        REQUIRE_FALSE(parser.atEnd());
+
+        String buf = "";
+        REQUIRE(parser.nextKey(&buf));
+        CHECK_THAT(buf.c_str(), Catch::Matchers::Equals("d\"key"));
+        REQUIRE(parser.parseInt() == 4);
+        REQUIRE_FALSE(parser.nextKey(key));
+        REQUIRE(parser.atEnd());
+    }
+}
+
+/** @brief Source that provides a json in blocks of a fixed size */
+class ChunkedSource : public JsonSource {
+    public:
+        ChunkedSource(const char* json, size_t chunkSize) : mJson(json), mLen(std::strlen(json)), mChunkSize(chunkSize) {}
+
+        size_t nextBlock(const char*& block) override {
+            size_t len = mLen - mOffset < mChunkSize ? mLen - mOffset : mChunkSize;
+            block = mJson + mOffset;
+            mOffset += len;
+            return len;
+        }
+    private:
+        const char* mJson;
+        size_t mLen;
+        size_t mChunkSize;
+        size_t mOffset = 0;
+};
+
+TEST_CASE("JsonParser with custom JsonSource", "[source]") {
+    std::vector<size_t> chunkSizes {1, 2, 3, 7, 16, 1024};
+
+    for(size_t chunkSize : chunkSizes) {
+        CAPTURE(chunkSize);
+
+        ChunkedSource source(BOOKS_JSON, chunkSize);
+        JsonParser parser(source);
+
+        REQUIRE(parser.enterObj());
+        REQUIRE(parser.find("books[0]/tags[1]"));
+        REQUIRE(parser.skipCollection());
+        REQUIRE(parser.exitCollection(2));
+        REQUIRE(parser.nextVal());
+        REQUIRE(parser.enterObj());
+
+        StringView title;
+        String author = "";
+        REQUIRE(parser.findKey("title"));
+        if(!parser.readString(title)) REQUIRE(parser.skipString()); // Title might not lie in a single block
+        else CHECK(std::string(title.data, title.length) == "The NeverEnding Story");
+        REQUIRE(parser.findKey("author"));
+        REQUIRE(parser.readString(author));
+        CHECK_THAT(author.c_str(), Catch::Matchers::Equals("Michael Ende"));
+
+        REQUIRE(parser.exitCollection(3));
+        CHECK_THAT(readRemaining(parser).c_str(), Catch::Matchers::Equals(", suffix"));
+    }
+}
+
+/** @brief Feeds a json in chunks of a fixed size to an incremental parser, whenever an operation needs more input */
+class ChunkFeeder {
+    public:
+        ChunkFeeder(JsonParser& parser, const char* json, size_t chunkSize) : mParser(parser), mJson(json), mLen(strlen(json)), mChunkSize(chunkSize) {
+            mParser.parseIncremental();
+        }
+
+        template<typename Fn> auto run(Fn op) -> decltype(op()) {
+            auto result = op();
+            while(mParser.needsMore()) {
+                if(mFed < mLen) {
+                    size_t len = mLen - mFed < mChunkSize ? mLen - mFed : mChunkSize;
+                    mParser.feed(mJson + mFed, len);
+                    mFed += len;
+                } else {
+                    mParser.endInput();
+                }
+                result = op();
+            }
+            return result;
+        }
+
+    private:
+        JsonParser& mParser;
+        const char* mJson;
+        size_t mLen;
+        size_t mChunkSize;
+        size_t mFed = 0;
+};
+
+TEST_CASE("Incremental JsonParser", "[incremental]") {
+    std::vector<size_t> chunkSizes {1, 2, 3, 7, 16, 1024};
+
+    SECTION("find & read values") {
+        for(size_t chunkSize : chunkSizes) {
+            CAPTURE(chunkSize);
+
+            JsonParser parser;
+            ChunkFeeder feeder(parser, BOOKS_JSON, chunkSize);
+
+            String author = "";
+            REQUIRE(feeder.run([&]() { return parser.enterObj(); }));
+            REQUIRE(feeder.run([&]() { return parser.find("books[1]/author"); }));
+            REQUIRE(feeder.run([&]() { return parser.readString(author); }));
+            CHECK_THAT(author.c_str(), Catch::Matchers::Equals("Michael Ende"));
+
+            REQUIRE(feeder.run([&]() { return parser.findKey("year"); }));
+            REQUIRE(feeder.run([&]() { return parser.parseInt(); }) == 1979);
+            REQUIRE(feeder.run([&]() { return parser.findKey("rating"); }));
+            REQUIRE(feeder.run([&]() { return parser.parseNum(); }) == Approx(0.425));
+
+            REQUIRE(feeder.run([&]() { return parser.exitCollection(3); }));
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            REQUIRE_FALSE(feeder.run([&]() { return parser.atEnd(); }));
+        }
+    }
+
+    SECTION("skip values") {
+        for(size_t chunkSize : chunkSizes) {
+            CAPTURE(chunkSize);
+
+            JsonParser parser;
+            ChunkFeeder feeder(parser, BOOKS_JSON, chunkSize);
+
+            Path path = Path("books[0]/tags[1]");
+            REQUIRE(feeder.run([&]() { return parser.enterObj(); }));
+            REQUIRE(feeder.run([&]() { return parser.find(path); }));
+            REQUIRE(feeder.run([&]() { return parser.skipCollection(); }));
+            REQUIRE_FALSE(feeder.run([&]() { return parser.nextVal(); }));
+            REQUIRE(feeder.run([&]() { return parser.exitCollection(); }));
+            REQUIRE_FALSE(feeder.run([&]() { return parser.nextKey(nullptr); }));
+            REQUIRE(feeder.run([&]() { return parser.exitCollection(); }));
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+
+            String key = "";
+            REQUIRE(feeder.run([&]() { return parser.enterObj(); }));
+            REQUIRE(feeder.run([&]() { return parser.nextKey(&key); }));
+            CHECK_THAT(key.c_str(), Catch::Matchers::Equals("title"));
+            REQUIRE(feeder.run([&]() { return parser.strcmp("The NeverEnding Story"); }) == 0);
+            REQUIRE(feeder.run([&]() { return parser.nextKey(nullptr); }));
+            REQUIRE(feeder.run([&]() { return parser.strcmp("Michael"); }) == -1);
+            REQUIRE(feeder.run([&]() { return parser.nextKey(nullptr); }));
+            REQUIRE(feeder.run([&]() { return parser.nextKey(nullptr); }));
+            REQUIRE(feeder.run([&]() { return parser.exitCollection(3); }));
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+        }
+    }
+
+    SECTION("read into fixed buffers") {
+        for(size_t chunkSize : chunkSizes) {
+            CAPTURE(chunkSize);
+
+            JsonParser parser;
+            ChunkFeeder feeder(parser, BOOKS_JSON, chunkSize);
+
+            char key[8];
+            char title[8];
+            size_t length = 0;
+            REQUIRE(feeder.run([&]() { return parser.enterObj(); }));
+            REQUIRE(feeder.run([&]() { return parser.find("books[1]"); }));
+            REQUIRE(feeder.run([&]() { return parser.enterObj(); }));
+            REQUIRE(feeder.run([&]() { return parser.nextKey(key, sizeof(key)); }));
+            CHECK_THAT(key, Catch::Matchers::Equals("title"));
+            REQUIRE(feeder.run([&]() { return parser.readString(title, sizeof(title), &length); }));
+            CHECK_THAT(title, Catch::Matchers::Equals("The Nev"));
+            CHECK(length == 21);
+            REQUIRE(feeder.run([&]() { return parser.nextKey(key, sizeof(key)); }));
+            CHECK_THAT(key, Catch::Matchers::Equals("author"));
+
+            String author = "";
+            REQUIRE(feeder.run([&]() { return parser.readStringChunks(title, 3, [&](const char* chunk, size_t len) {
+                for(size_t i=0; i<len; i++) author += chunk[i];
+            }); }));
+            CHECK_THAT(author.c_str(), Catch::Matchers::Equals("Michael Ende"));
+        }
+    }
+
+    SECTION("decode binary strings") {
+        for(size_t chunkSize : chunkSizes) {
+            CAPTURE(chunkSize);
+
+            JsonParser parser;
+            ChunkFeeder feeder(parser, "[\"TWFueSBoYW5k\\/z8=\", \"C0FFEE\"]", chunkSize);
+
+            byte buf[16];
+            size_t length = 0;
+            REQUIRE(feeder.run([&]() { return parser.enterArr(); }));
+            REQUIRE(feeder.run([&]() { return parser.readBase64(buf, sizeof(buf), &length); }));
+            REQUIRE(length == 11);
+            CHECK(std::memcmp(buf, "Many hand\xff\x3f", 11) == 0);
+
+            std::vector<byte> hex;
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            REQUIRE(feeder.run([&]() { return parser.readHexChunks(buf, 2, [&](const byte* chunk, size_t len) {
+                hex.insert(hex.end(), chunk, chunk + len);
+            }); }));
+            CHECK(hex == std::vector<byte>({0xc0, 0xff, 0xee}));
+        }
+    }
+
+    SECTION("parse arrays") {
+        for(size_t chunkSize : chunkSizes) {
+            CAPTURE(chunkSize);
+
+            JsonParser parser;
+            ChunkFeeder feeder(parser, "[1, -22, 333], [1.5, -2.25e1, 3], [-1, 2], false", chunkSize);
+
+            std::vector<long> ints;
+            REQUIRE(feeder.run([&]() { return parser.parseIntArray(ints); }));
+            REQUIRE(ints == std::vector<long>({1, -22, 333}));
+
+            std::vector<double> nums;
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            REQUIRE(feeder.run([&]() { return parser.parseNumArray(nums); }));
+            REQUIRE(nums == std::vector<double>({1.5, -22.5, 3}));
+
+            std::vector<unsigned int> uints;
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            REQUIRE(feeder.run([&]() { return parser.parseIntArray(uints); }));
+            REQUIRE(uints == std::vector<unsigned int>({2}));
+
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            REQUIRE_FALSE(feeder.run([&]() { return parser.parseBool(true); }));
+            REQUIRE(feeder.run([&]() { return parser.atEnd(); }));
+        }
+    }
+
+    SECTION("parse arrays in chunks") {
+        for(size_t chunkSize : chunkSizes) {
+            CAPTURE(chunkSize);
+
+            JsonParser parser;
+            ChunkFeeder feeder(parser, "[10, 20, 30, 40, 50], [1.5, 2.5, 3.5, 4.5], [7, 8, 9]", chunkSize);
+
+            std::vector<int32_t> ints;
+            int32_t intBuf[2];
+            REQUIRE(feeder.run([&]() {
+                return parser.parseIntArrayChunks(intBuf, 2, [&](const int32_t* chunk, size_t len) { ints.insert(ints.end(), chunk, chunk + len); });
+            }));
+            REQUIRE(ints == std::vector<int32_t>({10, 20, 30, 40, 50}));
+
+            std::vector<double> nums;
+            double numBuf[3];
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            REQUIRE(feeder.run([&]() {
+                return parser.parseNumArrayChunks(numBuf, 3, [&](const double* chunk, size_t len) { nums.insert(nums.end(), chunk, chunk + len); });
+            }));
+            REQUIRE(nums == std::vector<double>({1.5, 2.5, 3.5, 4.5}));
+
+            uint8_t bytes[2];
+            size_t count = 0;
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            REQUIRE(feeder.run([&]() { return parser.parseIntArray(bytes, 2, &count); }));
+            REQUIRE(count == 3);
+            REQUIRE(bytes[0] == 7);
+            REQUIRE(bytes[1] == 8);
+        }
+    }
+
+    SECTION("parse numbers without floating point") {
+        for(size_t chunkSize : chunkSizes) {
+            CAPTURE(chunkSize);
+
+            JsonParser parser;
+            ChunkFeeder feeder(parser, "[23.57, -1700000000123, 2.5e1]", chunkSize);
+
+            REQUIRE(feeder.run([&]() { return parser.enterArr(); }));
+            REQUIRE(feeder.run([&]() { return parser.parseFixed<2>(); }) == 2357);
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            Number number = feeder.run([&]() { return parser.parseNumber(); });
+            REQUIRE(number.type == Number::INT);
+            REQUIRE(number.integer == -1700000000123LL);
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            number = feeder.run([&]() { return parser.parseNumber(); });
+            REQUIRE(number.type == Number::DOUBLE);
+            REQUIRE(number.real == 25);
+        }
+    }
+
+    SECTION("parse 64 bit integers") {
+        for(size_t chunkSize : chunkSizes) {
+            CAPTURE(chunkSize);
+
+            JsonParser parser;
+            ChunkFeeder feeder(parser, "[1700000000123456789, -9223372036854775809], 18446744073709551615", chunkSize);
+
+            std::vector<int64_t> ints;
+            bool overflowed = false;
+            REQUIRE(feeder.run([&]() { return parser.parseIntArray(ints, false, &overflowed); }));
+            REQUIRE(ints == std::vector<int64_t>({1700000000123456789LL, INT64_MIN}));
+            REQUIRE(overflowed);
+
+            REQUIRE(feeder.run([&]() { return parser.nextVal(); }));
+            REQUIRE(feeder.run([&]() { return parser.parseInt<uint64_t>(0, &overflowed); }) == UINT64_MAX);
+            REQUIRE_FALSE(overflowed);
+        }
+    }
+
+    SECTION("truncated input") {
+        JsonParser parser;
+        ChunkFeeder feeder(parser, "{\"key\": \"val", 2);
+
+        String val = "";
+        REQUIRE(feeder.run([&]() { return parser.enterObj(); }));
+        REQUIRE(feeder.run([&]() { return parser.findKey("key"); }));
+        REQUIRE_FALSE(feeder.run([&]() { return parser.readString(val); }));
+        REQUIRE_FALSE(parser.needsMore());
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <FileSource.h>
+#include <cstdio>
+#include <unistd.h>
+
+TEST_CASE("JsonParser with file sources", "[source, file]") {
+    const char* json = "{\"meta\": {\"name\": \"dump\"}, \"series\": [[1, 2.5, -3e2], [4, 5, 6]], \"books\": [{\"author\": \"J. R. R. Tolkien\"}, {\"author\": \"Michael Ende\"}]}";
+
+    char path[] = "/tmp/jstream_XXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+    FILE* file = fdopen(fd, "w");
+    std::fputs(json, file);
+    std::fclose(file);
+
+    MMapSource mmapSource(path);
+    std::vector<JsonSource*> sources {&mmapSource};
+    REQUIRE(mmapSource.isOpen);
+
+    std::vector<size_t> blockSizes {1, 3, 16, 4096};
+    std::vector<PreadSource*> preadSources;
+    for(size_t blockSize : blockSizes) {
+        preadSources.push_back(new PreadSource(path, blockSize));
+        REQUIRE(preadSources.back()->isOpen);
+        sources.push_back(preadSources.back());
+    }
+
+    for(unsigned int sourceIdx=0; sourceIdx<sources.size(); sourceIdx++) {
+        CAPTURE(sourceIdx);
+
+        JsonParser parser(*sources.at(sourceIdx));
+        REQUIRE(parser.enterObj());
+        REQUIRE(parser.find("series[1]"));
+
+        std::vector<double> nums;
+        REQUIRE(parser.parseNumArray(nums));
+        REQUIRE(nums == std::vector<double>({4, 5, 6}));
+        REQUIRE(parser.exitCollection());
+
+        REQUIRE(parser.findKey("books"));
+        REQUIRE(parser.enterArr());
+        REQUIRE(parser.nextVal());
+        REQUIRE(parser.enterObj());
+        REQUIRE(parser.findKey("author"));
+        String author = "";
+        REQUIRE(parser.readString(author));
+        CHECK_THAT(author.c_str(), Catch::Matchers::Equals("Michael Ende"));
+        REQUIRE(parser.exitCollection(3));
+        REQUIRE(parser.read() == -1);
+    }
+
+    // Pipes can't be read at an offset
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(write(fds[1], json, std::strlen(json)) == static_cast<ssize_t>(std::strlen(json)));
+    close(fds[1]);
+    std::string pipePath = "/dev/fd/" + std::to_string(fds[0]);
+    PreadSource pipeSource(pipePath.c_str(), 16);
+    REQUIRE(pipeSource.isOpen);
+
+    JsonParser pipeParser(pipeSource);
+    REQUIRE(pipeParser.enterObj());
+    REQUIRE(pipeParser.find("series[0]"));
+    std::vector<double> nums;
+    REQUIRE(pipeParser.parseNumArray(nums));
+    REQUIRE(nums == std::vector<double>({1, 2.5, -3e2}));
+    REQUIRE_FALSE(pipeSource.failed);
+    close(fds[0]);
+
+    // Read errors aren't the end of the json
+    PreadSource dirSource("/tmp");
+    REQUIRE(dirSource.isOpen);
+    JsonParser dirParser(dirSource);
+    REQUIRE(dirParser.read() == -1);
+    REQUIRE(dirSource.failed);
+
+    // Missing file
+    REQUIRE_FALSE(MMapSource("/nonexistent/file.json").isOpen);
+    REQUIRE_FALSE(PreadSource("/nonexistent/file.json").isOpen);
+
+    for(PreadSource* source : preadSources) delete source;
+    std::remove(path);
+}
+#endif